@@ -0,0 +1,151 @@
+#include "async_checker.h"
+#include <string.h>
+
+async_checker::async_checker(checker_mode mode, uint64_t interval, uint64_t ring_size,
+                             capture_fn_t capture_fn, void *capture_context)
+{
+    assert(interval > 0);
+    assert((ring_size > 0) && ((ring_size & (ring_size - 1)) == 0));
+    this->mode = mode;
+    this->interval = interval;
+    countdown = interval;
+
+    this->ring_size = ring_size;
+    ring_mask = ring_size - 1;
+    ring = new commit_record_t[ring_size];
+    head.store(0);
+    tail.store(0);
+
+    this->capture_fn = capture_fn;
+    this->capture_context = capture_context;
+    has_diverged.store(false);
+    divergence_msg[0] = '\0';
+    n_checked.store(0);
+
+    running.store(mode == CHECK_ASYNC);
+    if (mode == CHECK_ASYNC)
+    {
+        assert(capture_fn);
+        worker = std::thread(&async_checker::drain, this);
+    }
+}
+
+async_checker::~async_checker()
+{
+    finish();
+    delete[] ring;
+}
+
+bool async_checker::sample()
+{
+    if (mode == CHECK_SYNC)
+        return true;
+
+    countdown--;
+    if (countdown == 0)
+    {
+        countdown = interval;
+        return true;
+    }
+    return false;
+}
+
+void async_checker::push(commit_record_t &rec)
+{
+    uint64_t t = tail.load(std::memory_order_relaxed);
+
+    ////read the functional simulator now, on this thread, while its entry is valid////
+    capture_fn(rec, capture_context);
+
+    ////wait for room in the ring////
+    while ((t - head.load(std::memory_order_acquire)) == ring_size)
+    {
+        if (has_diverged.load(std::memory_order_acquire))
+            return;
+        std::this_thread::yield();
+    }
+
+    ring[t & ring_mask] = rec;
+    tail.store(t + 1, std::memory_order_release);
+}
+
+void async_checker::drain()
+{
+    uint64_t h = head.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            if (!running.load(std::memory_order_acquire) && (h == tail.load(std::memory_order_acquire)))
+                break;
+            std::this_thread::yield();
+            continue;
+        }
+
+        const commit_record_t &rec = ring[h & ring_mask];
+        if (!has_diverged.load(std::memory_order_relaxed))
+        {
+            n_checked.fetch_add(1, std::memory_order_relaxed);
+            if (!compare(rec, divergence_msg, sizeof(divergence_msg)))
+            {
+                divergence = rec;
+                has_diverged.store(true, std::memory_order_release);
+            }
+        }
+
+        h++;
+        head.store(h, std::memory_order_release);
+    }
+}
+
+bool async_checker::compare(const commit_record_t &rec, char *msg, unsigned int len)
+{
+    if (rec.pc != rec.exp_pc)
+    {
+        snprintf(msg, len, "pc: pipeline 0x%016" PRIx64 ", functional simulator 0x%016" PRIx64, rec.pc, rec.exp_pc);
+        return false;
+    }
+    if (rec.exception != rec.exp_exception)
+    {
+        snprintf(msg, len, "exception: pipeline %s, functional simulator %s",
+                 (rec.exception ? "yes" : "no"), (rec.exp_exception ? "yes" : "no"));
+        return false;
+    }
+    if (!rec.exception && (rec.next_pc != rec.exp_next_pc))
+    {
+        snprintf(msg, len, "next pc: pipeline 0x%016" PRIx64 ", functional simulator 0x%016" PRIx64, rec.next_pc, rec.exp_next_pc);
+        return false;
+    }
+    if (!rec.exception && rec.C_valid && (rec.C_value != rec.exp_C_value))
+    {
+        snprintf(msg, len, "r%" PRIu64 ": pipeline 0x%016" PRIx64 ", functional simulator 0x%016" PRIx64,
+                 rec.C_log_reg, rec.C_value, rec.exp_C_value);
+        return false;
+    }
+    return true;
+}
+
+void async_checker::report(FILE *fp)
+{
+    if (!diverged())
+        return;
+
+    fprintf(fp, "CHECKER: first divergence, at checked instruction %" PRIu64 "\n", n_checked.load());
+    fprintf(fp, "CHECKER:    cycle %" PRIu64 ", sequence %" PRIu64 ", pc 0x%016" PRIx64 ", db_index %" PRIu64 "\n",
+            divergence.cycle, divergence.sequence, divergence.pc, divergence.db_index);
+    if (divergence.exception)
+        fprintf(fp, "CHECKER:    exception taken\n");
+    else if (divergence.C_valid)
+        fprintf(fp, "CHECKER:    dest r%" PRIu64 " = 0x%016" PRIx64 "\n", divergence.C_log_reg, divergence.C_value);
+    fprintf(fp, "CHECKER:    %s\n", divergence_msg);
+}
+
+void async_checker::finish()
+{
+    if (running.load())
+    {
+        running.store(false, std::memory_order_release);
+        worker.join();
+    }
+}
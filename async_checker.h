@@ -0,0 +1,134 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+#include <atomic>
+#include <thread>
+
+/////////////////////////////////////////////////////////////////////
+// Checker modes.
+// CHECK_SYNC:    check every retired instruction, in the Retire Stage.
+// CHECK_SAMPLED: check every Nth retired instruction, in the Retire Stage.
+// CHECK_ASYNC:   push every Nth retired instruction into a ring that a
+//                separate checker thread drains and checks.
+/////////////////////////////////////////////////////////////////////
+enum checker_mode {
+	CHECK_SYNC,
+	CHECK_SAMPLED,
+	CHECK_ASYNC
+};
+
+/////////////////////////////////////////////////////////////////////
+// One retired instruction (or taken exception), as seen by the
+// pipeline, and what the functional simulator expected of it.
+/////////////////////////////////////////////////////////////////////
+struct commit_record_t {
+	uint64_t sequence;
+	uint64_t pc;
+	uint64_t next_pc;	// pc of the next instruction (not checked for exceptions)
+	uint64_t db_index;	// corresponding instruction in the functional simulator
+	uint64_t cycle;
+	bool exception;
+	bool C_valid;
+	uint64_t C_log_reg;
+	uint64_t C_value;
+
+	// Filled in by the capture function (see capture_fn_t).
+	uint64_t exp_pc;
+	uint64_t exp_next_pc;
+	bool exp_exception;
+	uint64_t exp_C_value;
+};
+
+/////////////////////////////////////////////////////////////////////
+// Fills in the expected values of a record ('exp_*') from the
+// functional simulator's debug buffer entry rec.db_index.
+// It is called by push(), in the Retire Stage, while that entry is
+// still valid: the checker thread never reads simulator state, which
+// the pipeline keeps advancing and reusing.
+/////////////////////////////////////////////////////////////////////
+typedef void (*capture_fn_t)(commit_record_t &rec, void *context);
+
+class async_checker {
+private:
+	checker_mode mode;
+	uint64_t interval;	// check every Nth instruction (1: all)
+	uint64_t countdown;
+
+	/////////////////////////////////////////////////////////////////////
+	// Lock-free single-producer/single-consumer ring.
+	// The Retire Stage is the only producer (advances 'tail'), the
+	// checker thread is the only consumer (advances 'head').
+	/////////////////////////////////////////////////////////////////////
+	struct commit_record_t *ring;
+	uint64_t ring_size;	// power of two
+	uint64_t ring_mask;
+	std::atomic<uint64_t> head;
+	std::atomic<uint64_t> tail;
+
+	/////////////////////////////////////////////////////////////////////
+	// Checker thread.
+	/////////////////////////////////////////////////////////////////////
+	capture_fn_t capture_fn;
+	void *capture_context;
+	std::thread worker;
+	std::atomic<bool> running;
+
+	/////////////////////////////////////////////////////////////////////
+	// First divergence, with full context.
+	/////////////////////////////////////////////////////////////////////
+	std::atomic<bool> has_diverged;
+	struct commit_record_t divergence;
+	char divergence_msg[512];
+
+	std::atomic<uint64_t> n_checked;
+
+	void drain();
+
+	/////////////////////////////////////////////////////////////////////
+	// Compares a record with its expected values. Returns 'true' if
+	// they match. On a mismatch, it writes a description of the
+	// divergence into 'msg' (at most 'len' bytes).
+	/////////////////////////////////////////////////////////////////////
+	static bool compare(const commit_record_t &rec, char *msg, unsigned int len);
+
+public:
+	/////////////////////////////////////////////////////////////////////
+	// Inputs:
+	// 1. mode: see checker_mode.
+	// 2. interval: check every Nth instruction (CHECK_SAMPLED and
+	//    CHECK_ASYNC); 1 checks all of them.
+	// 3. ring_size: number of records in the ring (power of two).
+	// 4. capture_fn, capture_context: reads the expected values from
+	//    the functional simulator (CHECK_ASYNC only).
+	/////////////////////////////////////////////////////////////////////
+	async_checker(checker_mode mode, uint64_t interval, uint64_t ring_size,
+	              capture_fn_t capture_fn, void *capture_context);
+	~async_checker();
+
+	checker_mode get_mode() {return mode;}
+
+	/////////////////////////////////////////////////////////////////////
+	// Sampling: returns 'true' if the current retired instruction is
+	// one of the instructions that must be checked.
+	/////////////////////////////////////////////////////////////////////
+	bool sample();
+
+	/////////////////////////////////////////////////////////////////////
+	// Capture the expected values of a record and hand it to the
+	// checker thread. Spins while the ring is full.
+	/////////////////////////////////////////////////////////////////////
+	void push(commit_record_t &rec);
+
+	/////////////////////////////////////////////////////////////////////
+	// Returns 'true' once the checker thread has found a divergence.
+	// report() prints the divergence with its context.
+	/////////////////////////////////////////////////////////////////////
+	bool diverged() {return has_diverged.load(std::memory_order_acquire);}
+	void report(FILE *fp);
+
+	/////////////////////////////////////////////////////////////////////
+	// Wait until every pushed record has been checked, then stop the
+	// checker thread (end of simulation).
+	/////////////////////////////////////////////////////////////////////
+	void finish();
+};
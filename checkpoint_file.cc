@@ -0,0 +1,149 @@
+#include "checkpoint_file.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+checkpoint_file::checkpoint_file()
+{
+    fd = -1;
+    map = NULL;
+    map_size = 0;
+    header = NULL;
+}
+
+checkpoint_file::~checkpoint_file()
+{
+    close();
+}
+
+uint64_t checkpoint_file::page_size()
+{
+    return (uint64_t)sysconf(_SC_PAGESIZE);
+}
+
+uint64_t checkpoint_file::page_align(uint64_t n)
+{
+    uint64_t p = page_size();
+    return ((n + p - 1) / p) * p;
+}
+
+bool checkpoint_file::create(const char *path, const uint64_t sizes[NUMBER_CKPT_SECTIONS])
+{
+    close();
+
+    ////lay out the sections, each on a page boundary after the header page////
+    struct ckpt_section_t layout[NUMBER_CKPT_SECTIONS];
+    uint64_t offset = page_align(sizeof(ckpt_header_t));
+    for (unsigned int s = 0; s < NUMBER_CKPT_SECTIONS; s++)
+    {
+        layout[s].offset = offset;
+        layout[s].size = sizes[s];
+        offset += page_align(sizes[s]);
+    }
+
+    fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    map_size = offset;
+    if (ftruncate(fd, map_size) != 0)
+    {
+        close();
+        return false;
+    }
+
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        map = NULL;
+        close();
+        return false;
+    }
+
+    header = (ckpt_header_t *)map;
+    header->magic = CKPT_MAGIC;
+    header->version = CKPT_VERSION;
+    header->page_size = page_size();
+    header->file_size = map_size;
+    for (unsigned int s = 0; s < NUMBER_CKPT_SECTIONS; s++)
+        header->sections[s] = layout[s];
+    return true;
+}
+
+bool checkpoint_file::open(const char *path)
+{
+    struct stat st;
+
+    close();
+
+    fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    if ((fstat(fd, &st) != 0) || ((uint64_t)st.st_size < sizeof(ckpt_header_t)))
+    {
+        close();
+        return false;
+    }
+
+    ////private mapping: restoring never writes back to the file////
+    map_size = (uint64_t)st.st_size;
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        map = NULL;
+        close();
+        return false;
+    }
+
+    header = (ckpt_header_t *)map;
+    if ((header->magic != CKPT_MAGIC) || (header->version != CKPT_VERSION) ||
+        (header->page_size != page_size()) || (header->file_size != map_size))
+    {
+        close();
+        return false;
+    }
+
+    for (unsigned int s = 0; s < NUMBER_CKPT_SECTIONS; s++)
+    {
+        if ((header->sections[s].offset + header->sections[s].size) > map_size)
+        {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void *checkpoint_file::section(ckpt_section s)
+{
+    assert(header && (s < NUMBER_CKPT_SECTIONS));
+    if (header->sections[s].size == 0)
+        return NULL;
+    return ((char *)map + header->sections[s].offset);
+}
+
+uint64_t checkpoint_file::section_size(ckpt_section s)
+{
+    assert(header && (s < NUMBER_CKPT_SECTIONS));
+    return header->sections[s].size;
+}
+
+void checkpoint_file::close()
+{
+    if (map)
+    {
+        if (fd >= 0)
+            msync(map, map_size, MS_SYNC);
+        munmap(map, map_size);
+        map = NULL;
+    }
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+    map_size = 0;
+    header = NULL;
+}
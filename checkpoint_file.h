@@ -0,0 +1,84 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+/////////////////////////////////////////////////////////////////////
+// Sections of a pipeline checkpoint file.
+/////////////////////////////////////////////////////////////////////
+enum ckpt_section {
+	CKPT_SEC_PIPELINE = 0,	// pipeline_t scalars (cycle, pc, counters)
+	CKPT_SEC_ARCH_STATE,	// architectural state (state_t), including CSRs
+	CKPT_SEC_RENAMER,	// renamer (see renamer::save_state())
+	CKPT_SEC_BP,		// branch predictor
+	CKPT_SEC_MEMORY,	// memory image (all-zero pages are left as holes)
+	NUMBER_CKPT_SECTIONS
+};
+
+/////////////////////////////////////////////////////////////////////
+// Header in the first page of the file.
+// Every section starts on a page boundary, so that a restored section
+// is a page-aligned view of the mapping that can be used in place.
+/////////////////////////////////////////////////////////////////////
+#define CKPT_MAGIC	0x54504b4331323737ULL	// "721CKPT"
+#define CKPT_VERSION	2
+
+struct ckpt_section_t {
+	uint64_t offset;	// from the start of the file, page-aligned
+	uint64_t size;		// in bytes (0: section absent)
+};
+
+struct ckpt_header_t {
+	uint64_t magic;
+	uint64_t version;
+	uint64_t page_size;
+	uint64_t file_size;
+	struct ckpt_section_t sections[NUMBER_CKPT_SECTIONS];
+};
+
+class checkpoint_file {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// The whole file is memory-mapped. Saving writes each section
+	// directly into the mapping. Restoring maps the file privately
+	// (copy-on-write) and hands out pointers into the mapping: there is
+	// no parsing, and pages are read in lazily as they are touched.
+	/////////////////////////////////////////////////////////////////////
+	int fd;
+	void *map;
+	uint64_t map_size;
+	struct ckpt_header_t *header;
+
+	static uint64_t page_size();
+	static uint64_t page_align(uint64_t n);
+
+public:
+	checkpoint_file();
+	~checkpoint_file();
+
+	/////////////////////////////////////////////////////////////////////
+	// Create a checkpoint file for writing.
+	// sizes[s] is the size in bytes of section 's' (0: absent).
+	// Returns 'false' if the file cannot be created or mapped.
+	/////////////////////////////////////////////////////////////////////
+	bool create(const char *path, const uint64_t sizes[NUMBER_CKPT_SECTIONS]);
+
+	/////////////////////////////////////////////////////////////////////
+	// Open an existing checkpoint file for restoring.
+	// Returns 'false' if the file cannot be mapped, or if its magic
+	// number or version does not match.
+	/////////////////////////////////////////////////////////////////////
+	bool open(const char *path);
+
+	/////////////////////////////////////////////////////////////////////
+	// Page-aligned start of a section within the mapping, and its size.
+	// section() returns NULL for an absent section.
+	/////////////////////////////////////////////////////////////////////
+	void *section(ckpt_section s);
+	uint64_t section_size(ckpt_section s);
+
+	/////////////////////////////////////////////////////////////////////
+	// Unmap the file (a file being written is synced first).
+	// Pointers returned by section() are invalid afterwards.
+	/////////////////////////////////////////////////////////////////////
+	void close();
+};
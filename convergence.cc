@@ -0,0 +1,149 @@
+#include "convergence.h"
+#include <math.h>
+
+static const char *conv_metric_name[NUMBER_CONV_METRICS] = {
+    "IPC",
+    "recoveries/insn",
+    "stall_reg/cycle",
+    "stall_branch/cycle",
+    "stall_dispatch/cycle"
+};
+
+////two-sided 95% Student-t quantiles, t(0.975, df), for df = 1..30////
+static const double t975[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+convergence_monitor::convergence_monitor(unsigned int metrics, uint64_t window, unsigned int k, double tolerance)
+{
+    assert(!metrics || (window > 0));
+    assert(!metrics || (k >= 2));
+    this->metrics = metrics;
+    this->window = window;
+    this->k = k;
+    this->tolerance = tolerance;
+
+    next_boundary = window;
+    last_boundary = 0;
+    last.num_insn = 0;
+    last.commit_count = 0;
+    last.recovery_count = 0;
+    last.stall_reg = 0;
+    last.stall_branch = 0;
+    last.stall_dispatch = 0;
+
+    for (unsigned int m = 0; m < NUMBER_CONV_METRICS; m++)
+        values[m] = new double[(k > 0) ? k : 1];
+    n_windows = 0;
+    has_converged = false;
+}
+
+convergence_monitor::~convergence_monitor()
+{
+    for (unsigned int m = 0; m < NUMBER_CONV_METRICS; m++)
+        delete[] values[m];
+}
+
+bool convergence_monitor::end_window(uint64_t cycle, const conv_counts_t &counts)
+{
+    if (!enabled())
+        return false;
+
+    assert(cycle > last_boundary);
+    double cycles = (double)(cycle - last_boundary);
+    double committed = (double)(counts.commit_count - last.commit_count);
+    double v[NUMBER_CONV_METRICS];
+
+    v[CONV_IPC] = (double)(counts.num_insn - last.num_insn) / cycles;
+    v[CONV_RECOVERY] = ((committed > 0.0) ? ((double)(counts.recovery_count - last.recovery_count) / committed) : 0.0);
+    v[CONV_STALL_REG] = (double)(counts.stall_reg - last.stall_reg) / cycles;
+    v[CONV_STALL_BRANCH] = (double)(counts.stall_branch - last.stall_branch) / cycles;
+    v[CONV_STALL_DISPATCH] = (double)(counts.stall_dispatch - last.stall_dispatch) / cycles;
+
+    for (unsigned int m = 0; m < NUMBER_CONV_METRICS; m++)
+        values[m][n_windows % k] = v[m];
+    n_windows++;
+    last = counts;
+    last_boundary = cycle;
+    next_boundary = cycle + window;
+
+    if (n_windows < k)
+        return false;
+
+    ////converged if every selected metric is within the tolerance band////
+    has_converged = true;
+    for (unsigned int m = 0; m < NUMBER_CONV_METRICS; m++)
+    {
+        if ((metrics & CONV_MASK(m)) && (spread((conv_metric)m) > tolerance))
+        {
+            has_converged = false;
+            break;
+        }
+    }
+    return has_converged;
+}
+
+double convergence_monitor::mean(conv_metric m)
+{
+    unsigned int n = ((n_windows < k) ? n_windows : k);
+    double sum = 0.0;
+    for (unsigned int i = 0; i < n; i++)
+        sum += values[m][i];
+    return (n ? (sum / (double)n) : 0.0);
+}
+
+double convergence_monitor::spread(conv_metric m)
+{
+    unsigned int n = ((n_windows < k) ? n_windows : k);
+    if (n == 0)
+        return 0.0;
+
+    double lo = values[m][0];
+    double hi = values[m][0];
+    for (unsigned int i = 1; i < n; i++)
+    {
+        if (values[m][i] < lo) lo = values[m][i];
+        if (values[m][i] > hi) hi = values[m][i];
+    }
+
+    double mu = mean(m);
+    if (mu == 0.0)
+        return ((hi == lo) ? 0.0 : HUGE_VAL);	// a metric that stays at 0 is stable
+    return ((hi - lo) / 2.0 / fabs(mu));
+}
+
+double convergence_monitor::ci(conv_metric m)
+{
+    unsigned int n = ((n_windows < k) ? n_windows : k);
+    if (n < 2)
+        return 0.0;
+
+    double mu = mean(m);
+    double ss = 0.0;
+    for (unsigned int i = 0; i < n; i++)
+        ss += (values[m][i] - mu) * (values[m][i] - mu);
+    double s = sqrt(ss / (double)(n - 1));
+
+    ////few windows: Student-t quantile; beyond 30 degrees of freedom, the normal 1.96 is within 4%////
+    double t = (((n - 1) <= 30) ? t975[n - 2] : 1.96);
+    return ((mu != 0.0) ? (t * s / sqrt((double)n) / fabs(mu)) : 0.0);
+}
+
+void convergence_monitor::report(FILE *fp)
+{
+    if (!enabled())
+        return;
+
+    fprintf(fp, "CONVERGENCE: window = %" PRIu64 " cycles, k = %u, tolerance = +/- %.2f%%, windows = %u\n",
+            window, k, 100.0*tolerance, n_windows);
+    fprintf(fp, "CONVERGENCE: %s\n", (has_converged ? "converged" : "NOT converged"));
+    for (unsigned int m = 0; m < NUMBER_CONV_METRICS; m++)
+    {
+        if (!(metrics & CONV_MASK(m)))
+            continue;
+        fprintf(fp, "CONVERGENCE: %-20s mean = %.6f, band = +/- %.2f%%, approx. 95%% CI = +/- %.2f%%\n",
+                conv_metric_name[m], mean((conv_metric)m), 100.0*spread((conv_metric)m), 100.0*ci((conv_metric)m));
+    }
+}
@@ -0,0 +1,97 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+/////////////////////////////////////////////////////////////////////
+// Metrics that the convergence monitor can track (bit mask).
+/////////////////////////////////////////////////////////////////////
+enum conv_metric {
+	CONV_IPC = 0,		// retired instructions per cycle
+	CONV_RECOVERY,		// recoveries (complete squashes) per committed instruction
+	CONV_STALL_REG,		// rename stalls on physical registers, per cycle
+	CONV_STALL_BRANCH,	// rename stalls on checkpoints, per cycle
+	CONV_STALL_DISPATCH,	// dispatch stalls on the Active List, per cycle
+	NUMBER_CONV_METRICS
+};
+
+#define CONV_MASK(m)	(1U << (m))
+
+/////////////////////////////////////////////////////////////////////
+// Cumulative counts sampled by the monitor at each window boundary.
+/////////////////////////////////////////////////////////////////////
+struct conv_counts_t {
+	uint64_t num_insn;
+	uint64_t commit_count;
+	uint64_t recovery_count;
+	uint64_t stall_reg;
+	uint64_t stall_branch;
+	uint64_t stall_dispatch;
+};
+
+class convergence_monitor {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// Convergence-based early termination.
+	//
+	// Every 'window' cycles, the monitor computes each selected metric
+	// over the window just ended. A window may be longer than 'window'
+	// cycles if idle cycles were skipped across its boundary: rates are
+	// taken over its actual length. The run has converged once, for every
+	// selected metric, the last 'k' window values lie within a relative
+	// band of +/- 'tolerance' around their mean.
+	/////////////////////////////////////////////////////////////////////
+	unsigned int metrics;	// CONV_MASK() bits; 0: monitor disabled
+	uint64_t window;	// cycles
+	unsigned int k;
+	double tolerance;
+
+	uint64_t next_boundary;	// cycle of the next window boundary
+	uint64_t last_boundary;	// cycle at which the current window started
+	struct conv_counts_t last;
+
+	/////////////////////////////////////////////////////////////////////
+	// Last 'k' window values of each metric (circular).
+	/////////////////////////////////////////////////////////////////////
+	double *values[NUMBER_CONV_METRICS];
+	unsigned int n_windows;	// windows seen so far
+	bool has_converged;
+
+	double mean(conv_metric m);
+	double spread(conv_metric m);	// (max - min) / 2 / mean
+	double ci(conv_metric m);	// 95% CI half-width / mean, over the last 'k' windows
+
+public:
+	/////////////////////////////////////////////////////////////////////
+	// Inputs:
+	// 1. metrics: CONV_MASK() bits of the metrics to track (0: disabled).
+	// 2. window: window length, in cycles.
+	// 3. k: number of consecutive stable windows required (>= 2).
+	// 4. tolerance: relative tolerance (e.g., 0.01 for +/- 1%).
+	/////////////////////////////////////////////////////////////////////
+	convergence_monitor(unsigned int metrics, uint64_t window, unsigned int k, double tolerance);
+	~convergence_monitor();
+
+	bool enabled() {return (metrics != 0);}
+
+	/////////////////////////////////////////////////////////////////////
+	// Called once per cycle. Returns 'true' once the run has converged:
+	// the caller may end the simulation.
+	/////////////////////////////////////////////////////////////////////
+	bool tick(uint64_t cycle, const conv_counts_t &counts)
+	{
+		if (cycle < next_boundary)
+			return has_converged;
+		return end_window(cycle, counts);
+	}
+	bool end_window(uint64_t cycle, const conv_counts_t &counts);
+	bool converged() {return has_converged;}
+
+	/////////////////////////////////////////////////////////////////////
+	// Final report: per metric, the mean over the last 'k' windows, the
+	// achieved relative band, and the relative 95% confidence interval.
+	// The interval uses the Student-t quantile for k - 1 degrees of
+	// freedom. It is approximate: consecutive windows of one run are
+	// treated as independent samples, which they are not exactly.
+	/////////////////////////////////////////////////////////////////////
+	void report(FILE *fp);
+};
@@ -1,6 +1,8 @@
 #include "pipeline.h"
 #include "debug.h"
 #include "trap.h"
+#include "timeline.h"
+#include "squash_epoch.h"
 
 
 void pipeline_t::dispatch() {
@@ -15,6 +17,7 @@ void pipeline_t::dispatch() {
    bool A_ready;
    bool B_ready;
    bool D_ready;
+   unsigned int iq_entry;
    db_t* actual;
 
    // Stall the Dispatch Stage if either:
@@ -23,8 +26,12 @@ void pipeline_t::dispatch() {
    // (3) There aren't enough IQ entries for the dispatch bundle.
    // (4) There aren't enough LQ/SQ entries for the dispatch bundle.
 
+   // Branches that resolved correctly in the Writeback Stage this cycle free their checkpoints
+   // and branch-mask bits here, before Rename2 can allocate them again.
+   resolve_batch();
+
    // First stall condition: There isn't a dispatch bundle.
-   if (!DISPATCH[0].valid) {
+   if (!REG_VALID(DISPATCH[0])) {
       return;
    }
 
@@ -34,8 +41,13 @@ void pipeline_t::dispatch() {
    // * If the Active List does not have enough entries for the *whole* dispatch bundle (which is always comprised of 'dispatch_width' instructions),
    //   then stall the Dispatch Stage. Stalling is achieved by returning from this function ('return').
    // * Else, don't stall the Dispatch Stage. This is achieved by doing nothing and proceeding to the next statements.
+   // Shadow renamers observe the same resource check (sizing studies).
+   if (SHADOW.enabled())
+      SHADOW.dispatch(REN->get_active_size(), dispatch_width);
+
    if(REN->stall_dispatch(dispatch_width))
    {
+      REN->count_stall_dispatch();
       return;
    }
 
@@ -49,11 +61,11 @@ void pipeline_t::dispatch() {
    bundle_load = 0;
    bundle_store = 0;
    for (i = 0; i < dispatch_width; i++) {
-      assert(DISPATCH[i].valid);
+      assert(REG_VALID(DISPATCH[i]));
       index = DISPATCH[i].index;
 
       // Check IQ requirement.
-      switch (PAY.buf[index].iq) {
+      switch (PAY.hot(index).iq) {
          case SEL_IQ:
             // Increment number of instructions to be dispatched to unified IQ.
             bundle_inst++;
@@ -70,22 +82,25 @@ void pipeline_t::dispatch() {
       }
 
       // Check LQ/SQ requirement.
-      if (IS_LOAD(PAY.buf[index].flags)) {
+      if (IS_LOAD(PAY.hot(index).flags)) {
          bundle_load++;
       }
-      else if (IS_STORE(PAY.buf[index].flags)) {
+      else if (IS_STORE(PAY.hot(index).flags)) {
          // Special cases:
          // S_S and S_D are split-stores, i.e., they are split into an addr-op and a value-op.
          // The two ops share a SQ entry to "rejoin". Therefore, only the first op should check
          // for and allocate a SQ entry; the second op should inherit the same entry.
-         if (!PAY.buf[index].split_store || PAY.buf[index].upper) {
+         if (!PAY.hot(index).split_store || PAY.hot(index).upper) {
             bundle_store++;
          }
       }
    }
 
    // Now, check for available entries in the unified IQ and the LQ/SQ.
-   if (IQ.stall(bundle_inst) || LSU.stall(bundle_load, bundle_store)) {
+   // With speculative load-hit wakeup, 'issue_width' IQ entries stay free for instructions replayed
+   // from the Register Read Stage (the pipeline's constructor checks that the IQ is large enough for
+   // this, see load_hit_pred::iq_fits()).
+   if (IQ.stall(bundle_inst + (SPEC_LOAD_WAKEUP ? issue_width : 0)) || LSU.stall(bundle_load, bundle_store)) {
       return;
    }
 
@@ -94,44 +109,53 @@ void pipeline_t::dispatch() {
    // Making it this far means we have all the required resources to dispatch the dispatch bundle.
    //
    for (i = 0; i < dispatch_width; i++) {
-      assert(DISPATCH[i].valid);
+      assert(REG_VALID(DISPATCH[i]));
       index = DISPATCH[i].index;
 
+      TIMELINE.stamp(index, TL_DISPATCH, cycle);
+
       // Choose an execution lane for the instruction.
-      PAY.buf[index].lane_id = (PRESTEER ? steer(PAY.buf[index].fu) : fu_lane_matrix[(unsigned int)PAY.buf[index].fu]);
+      PAY.hot(index).lane_id = (PRESTEER ? steer(index) : fu_lane_matrix[(unsigned int)PAY.hot(index).fu]);
 
       // FIX_ME #7
       // Dispatch the instruction into the Active List.
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. The renamer class' function for dispatching an instruction into its Active List takes nine different arguments.
       //    Six of these arguments are control flags:
       //    a. dest_valid: The instruction's payload has information about whether or not the instruction
       //       has a destination register.
       //    b. load: You can efficiently detect loads by testing the instruction's flags with the IS_LOAD() macro,
       //       as shown below. Use the local variable 'load_flag' (already declared):
-      //       load_flag = IS_LOAD(PAY.buf[index].flags);
+      //       load_flag = IS_LOAD(PAY.hot(index).flags);
       //    c. store: You can efficiently detect stores by testing the instruction's flags with the IS_STORE() macro,
       //       as shown below. Use the local variable 'store_flag' (already declared):
-      //       store_flag = IS_STORE(PAY.buf[index].flags);
+      //       store_flag = IS_STORE(PAY.hot(index).flags);
       //    d. branch: You can efficiently detect branches by testing the instruction's flags with the IS_BRANCH() macro,
       //       as shown below. Use the local variable 'branch_flag' (already declared):
-      //       branch_flag = IS_BRANCH(PAY.buf[index].flags);
+      //       branch_flag = IS_BRANCH(PAY.hot(index).flags);
       //    e. amo: You can efficiently detect atomic memory operations by testing the instruction's flags with the IS_AMO() macro,
       //       as shown below. Use the local variable 'amo_flag' (already declared):
-      //       amo_flag = IS_AMO(PAY.buf[index].flags);
+      //       amo_flag = IS_AMO(PAY.hot(index).flags);
       //    f. csr: You can efficiently detect system instructions by testing the instruction's flags with the IS_CSR() macro,
       //       as shown below. Use the local variable 'csr_flag' (already declared):
-      //       csr_flag = IS_CSR(PAY.buf[index].flags);
+      //       csr_flag = IS_CSR(PAY.hot(index).flags);
       // 3. When you dispatch the instruction into the Active List, remember to *update* the instruction's
       //    payload with its Active List index.
-      load_flag = IS_LOAD(PAY.buf[index].flags);
-      store_flag = IS_STORE(PAY.buf[index].flags);
-      branch_flag = IS_BRANCH(PAY.buf[index].flags);
-      amo_flag = IS_AMO(PAY.buf[index].flags);
-      csr_flag = IS_CSR(PAY.buf[index].flags);
-      PAY.buf[index].AL_index = REN->dispatch_inst(PAY.buf[index].C_valid, PAY.buf[index].C_log_reg, PAY.buf[index].C_phys_reg, load_flag, store_flag, branch_flag, amo_flag, csr_flag, PAY.buf[index].pc);
+      load_flag = IS_LOAD(PAY.hot(index).flags);
+      store_flag = IS_STORE(PAY.hot(index).flags);
+      branch_flag = IS_BRANCH(PAY.hot(index).flags);
+      amo_flag = IS_AMO(PAY.hot(index).flags);
+      csr_flag = IS_CSR(PAY.hot(index).flags);
+      if (csr_flag && renamed_csr_read(index)) {
+         // A renamed CSR read executes speculatively in its lane, like an ALU instruction: it is not a
+         // system instruction for the Active List, so it neither executes at retirement nor squashes the
+         // pipeline. Fetch stalled behind it, waiting for the serializing squash: let fetch resume.
+         csr_flag = false;
+         clear_fetch_csr();
+      }
+      PAY.hot(index).AL_index = REN->dispatch_inst(PAY.hot(index).C_valid, PAY.cold(index).C_log_reg, PAY.hot(index).C_phys_reg, load_flag, store_flag, branch_flag, amo_flag, csr_flag, PAY.cold(index).pc);
 
 
       // FIX_ME #8
@@ -139,7 +163,7 @@ void pipeline_t::dispatch() {
       // These will be used to initialize the instruction's ready bits in the Issue Queue.
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. When you implement the logic for determining readiness of the three source registers, A, B, and D,
       //    put the results of your calculations into the local variables 'A_ready', 'B_ready', and 'D_ready'.
       //    These local variables are already declared for you. You can then use these ready flags
@@ -148,20 +172,20 @@ void pipeline_t::dispatch() {
       //    since the Issue Queue must not wait for a non-existent register. On the other hand, if the
       //    instruction does have a given source register, then you must consult the renamer module
       //    to determine whether or not the register is ready.
-      A_ready = REN->is_ready(PAY.buf[index].A_phys_reg);
-      if(!(PAY.buf[index].A_valid))
+      A_ready = REN->is_ready(PAY.hot(index).A_phys_reg);
+      if(!(PAY.hot(index).A_valid))
       {
          A_ready = true;
       }
 
-      B_ready = REN->is_ready(PAY.buf[index].B_phys_reg);
-      if(!(PAY.buf[index].B_valid))
+      B_ready = REN->is_ready(PAY.hot(index).B_phys_reg);
+      if(!(PAY.hot(index).B_valid))
       {
          B_ready = true;
       }
       
-      D_ready = REN->is_ready(PAY.buf[index].D_phys_reg);
-      if(!(PAY.buf[index].D_valid))
+      D_ready = REN->is_ready(PAY.hot(index).D_phys_reg);
+      if(!(PAY.hot(index).D_valid))
       {
          D_ready = true;
       }
@@ -176,19 +200,29 @@ void pipeline_t::dispatch() {
       // alternative in the FabScalar library, by the way.)
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. If the instruction has a destination register, then clear its ready bit; otherwise do nothing.
-      if(PAY.buf[index].C_valid)
+      if(PAY.hot(index).C_valid)
       {
-         REN->clear_ready(PAY.buf[index].C_phys_reg);
+         REN->clear_ready(PAY.hot(index).C_phys_reg);
       }
 
+      // Speculative load-hit wakeup: the destination is now owned by this instruction, not by an older,
+      // squashed load that may have woken it early.
+      if (SPEC_LOAD_WAKEUP && PAY.hot(index).C_valid)
+         LHP.allocate(PAY.hot(index).C_phys_reg);
+
+      // Value prediction: a confidently-predicted result is written into the destination register,
+      // which is marked ready, so that consumers dispatched after this instruction need not wait for it.
+      if (VALUE_PRED && PAY.hot(index).C_valid)
+         value_predict(index, DISPATCH[i].branch_mask);
+
 
       // FIX_ME #10
       // Dispatch the instruction into the Issue Queue, or circumvent the Issue Queue and immediately update status in the Active List.
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. The Decode Stage has already set the 'iq' field of the instruction's payload.
       //    It is an enumerated type with three possible values (refer to payload.h), corresponding to:
       //    * Dispatch the instruction into the Issue Queue.
@@ -196,19 +230,18 @@ void pipeline_t::dispatch() {
       //    * Skip the Issue Queue and early-complete the instruction, moreover, post an exception (system call).
       //    The switch statement below enumerates the three cases for you. You must implement the code for each case.
 
-      trap_t* t;
-      uint64_t funct12 = PAY.buf[index].inst.csr();
+      uint64_t funct12 = PAY.cold(index).inst.csr();
 
-      switch (PAY.buf[index].iq) {
+      switch (PAY.hot(index).iq) {
          case SEL_IQ:
             // FIX_ME #10a
             // Dispatch the instruction into the IQ.
             //
             // Tips:
-            // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+            // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
             // 2. You only need to implement one statement: a call to the Issue Queue's dispatch function.
             //    See file issue_queue.h to determine the arguments that need to be passed in. Here is some clarification:
-            //    * 'index' argument: the instruction's index into PAY.buf[]
+            //    * 'index' argument: the instruction's index into the payload (PAY)
             //    * 'branch_mask' argument: pass in the branch_mask of the instruction currently being dispatched
             //      from the DISPATCH pipeline register, i.e., DISPATCH[i].branch_mask
             //    * 'lane_id' argument: pass in the instruction's lane_id, its chosen execution lane (it was determined by the steering logic, above).
@@ -216,9 +249,22 @@ void pipeline_t::dispatch() {
             //    * 'B_valid', 'B_ready', and 'B_tag': Valid bit, ready bit (calculated above), and physical register of second source register.
             //    * 'D_valid', 'D_ready', and 'D_tag': Valid bit, ready bit (calculated above), and physical register of third source register.
             // 3. As you can see in file pipeline.h, the IQ variable is the Issue Queue itself, NOT a pointer to it.
-            IQ.dispatch(index, DISPATCH[i].branch_mask, PAY.buf[index].lane_id, PAY.buf[index].A_valid, A_ready, PAY.buf[index].A_phys_reg, 
-                        PAY.buf[index].B_valid, B_ready, PAY.buf[index].B_phys_reg, PAY.buf[index].D_valid, D_ready, PAY.buf[index].D_phys_reg);
-
+            iq_entry = IQ.dispatch(index, DISPATCH[i].branch_mask, PAY.hot(index).lane_id, PAY.hot(index).A_valid, A_ready, PAY.hot(index).A_phys_reg, 
+                        PAY.hot(index).B_valid, B_ready, PAY.hot(index).B_phys_reg, PAY.hot(index).D_valid, D_ready, PAY.hot(index).D_phys_reg);
+
+            // Register each not-ready source on the consumer list of its physical register,
+            // so that wakeup() only touches the actual consumers instead of every IQ entry.
+            if (!A_ready)
+               WL.add(PAY.hot(index).A_phys_reg, iq_entry, OPERAND_A, DISPATCH[i].branch_mask);
+            if (!B_ready)
+               WL.add(PAY.hot(index).B_phys_reg, iq_entry, OPERAND_B, DISPATCH[i].branch_mask);
+            if (!D_ready)
+               WL.add(PAY.hot(index).D_phys_reg, iq_entry, OPERAND_D, DISPATCH[i].branch_mask);
+            if (SPEC_LOAD_WAKEUP)
+               record_spec_consumers(index, iq_entry);
+
+            if (PRESTEER)
+               STEER.enter(PAY.hot(index).lane_id, DISPATCH[i].branch_mask);
 
             break;
 
@@ -230,24 +276,21 @@ void pipeline_t::dispatch() {
             // Set exception bit in Active List, for fetch-exception-related NOPs.
             //
             // Tips:
-            // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+            // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
 
             // *** FIX_ME #10b (part 1): Set completed bit in Active List.
-            REN->set_complete(PAY.buf[index].AL_index);
+            REN->set_complete(PAY.hot(index).AL_index);
 
         
             // Check if this is a NOP with a fetch exception.
             // If so, throw the appropriate exception.
-            if (PAY.buf[index].fetch_exception) {
-               if (PAY.buf[index].fetch_exception_cause == CAUSE_MISALIGNED_FETCH)
-                  t = new trap_instruction_address_misaligned(PAY.buf[index].pc);
-               else if (PAY.buf[index].fetch_exception_cause == CAUSE_FAULT_FETCH)
-                  t = new trap_instruction_access_fault(PAY.buf[index].pc);
-
-               PAY.buf[index].trap = t;
+            if (PAY.cold(index).fetch_exception) {
+               assert((PAY.cold(index).fetch_exception_cause == CAUSE_MISALIGNED_FETCH) ||
+                      (PAY.cold(index).fetch_exception_cause == CAUSE_FAULT_FETCH));
+               PAY.cold(index).trap.post(PAY.cold(index).fetch_exception_cause, PAY.cold(index).pc);
 
                // *** FIX_ME #10b (part 2): Set exception bit in Active List.
-               REN->set_exception(PAY.buf[index].AL_index);
+               REN->set_exception(PAY.hot(index).AL_index);
 
 
             }
@@ -260,21 +303,19 @@ void pipeline_t::dispatch() {
             // Set exception bit in Active List.
             //
             // Tips:
-            // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+            // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
 
             // *** FIX_ME #10c: Set both the completed bit and the exception bit in the Active List.
-            REN->set_complete(PAY.buf[index].AL_index);
-            REN->set_exception(PAY.buf[index].AL_index);
+            REN->set_complete(PAY.hot(index).AL_index);
+            REN->set_exception(PAY.hot(index).AL_index);
 
  
             if (funct12 == FN12_SCALL)
-               t = new trap_syscall();
+               PAY.cold(index).trap.post(CAUSE_SYSCALL);
             else if (funct12 == FN12_SBREAK)
-               t = new trap_breakpoint();
+               PAY.cold(index).trap.post(CAUSE_BREAKPOINT);
             else
                assert(0); // Should not come here.
-
-            PAY.buf[index].trap = t;
             break;
 
          default:
@@ -283,100 +324,127 @@ void pipeline_t::dispatch() {
       }
 
 
-      if (IS_FP_OP(PAY.buf[index].flags)) {
+      if (IS_FP_OP(PAY.hot(index).flags)) {
 #ifndef RISCV_ENABLE_FPU
          // Floating-point ISA extension is disabled: illegal instruction exception.
-         REN->set_exception(PAY.buf[index].AL_index);
-         PAY.buf[index].trap = new trap_illegal_instruction();
+         REN->set_exception(PAY.hot(index).AL_index);
+         PAY.cold(index).trap.post(CAUSE_ILLEGAL_INSTRUCTION);
 #else
          if (unlikely(!(get_state()->sr & SR_EF))) {
             // Floating-point ISA extension is enabled.
             // The pipeline cannot natively execute FP instructions, however: trap to software FP library.
-            REN->set_exception(PAY.buf[index].AL_index);
-            PAY.buf[index].trap = new trap_fp_disabled();
+            REN->set_exception(PAY.hot(index).AL_index);
+            PAY.cold(index).trap.post(CAUSE_FP_DISABLED);
         }
 #endif
       }
 
 
       // Dispatch loads and stores into the LQ/SQ and record their LQ/SQ indices.
-      if (IS_MEM_OP(PAY.buf[index].flags)) {
-         if (!PAY.buf[index].split_store || PAY.buf[index].upper) {
-            LSU.dispatch(IS_LOAD(PAY.buf[index].flags),
-                         PAY.buf[index].size,
-                         PAY.buf[index].left,
-                         PAY.buf[index].right,
-                         PAY.buf[index].is_signed,
+      if (IS_MEM_OP(PAY.hot(index).flags)) {
+         if (!PAY.hot(index).split_store || PAY.hot(index).upper) {
+            LSU.dispatch(IS_LOAD(PAY.hot(index).flags),
+                         PAY.cold(index).size,
+                         PAY.cold(index).left,
+                         PAY.cold(index).right,
+                         PAY.cold(index).is_signed,
                          index,
-                         PAY.buf[index].LQ_index, PAY.buf[index].LQ_phase,
-                         PAY.buf[index].SQ_index, PAY.buf[index].SQ_phase,
-			 (IS_LOAD(PAY.buf[index].flags) && (!SPEC_DISAMBIG || (MEM_DEP_PRED && (MDP.find(PAY.buf[index].pc) != MDP.end())))));
+                         PAY.hot(index).LQ_index, PAY.hot(index).LQ_phase,
+                         PAY.hot(index).SQ_index, PAY.hot(index).SQ_phase,
+			 (IS_LOAD(PAY.hot(index).flags) && (!SPEC_DISAMBIG || (MEM_DEP_PRED && MDP.predict(PAY.cold(index).pc, cycle)))));
 
             // The lower part of a split-store should inherit the same LSU indices.
-            if (PAY.buf[index].split_store) {
-               assert(PAY.buf[index+1].split && !PAY.buf[index+1].upper);
-               PAY.buf[index+1].LQ_index = PAY.buf[index].LQ_index;
-               PAY.buf[index+1].LQ_phase = PAY.buf[index].LQ_phase;
-               PAY.buf[index+1].SQ_index = PAY.buf[index].SQ_index;
-               PAY.buf[index+1].SQ_phase = PAY.buf[index].SQ_phase;
+            if (PAY.hot(index).split_store) {
+               assert(PAY.hot(index+1).split && !PAY.hot(index+1).upper);
+               PAY.hot(index+1).LQ_index = PAY.hot(index).LQ_index;
+               PAY.hot(index+1).LQ_phase = PAY.hot(index).LQ_phase;
+               PAY.hot(index+1).SQ_index = PAY.hot(index).SQ_index;
+               PAY.hot(index+1).SQ_phase = PAY.hot(index).SQ_phase;
             }
 
             // Oracle memory disambiguation support.
-            if (ORACLE_DISAMBIG && PAY.buf[index].good_instruction && IS_STORE(PAY.buf[index].flags)) {
+            if (ORACLE_DISAMBIG && PAY.cold(index).good_instruction && IS_STORE(PAY.hot(index).flags)) {
                // Get pointer to the corresponding instruction in the functional simulator.
-               actual = get_pipe()->peek(PAY.buf[index].db_index);
+               actual = get_pipe()->peek(PAY.cold(index).db_index);
 
                // Place oracle store address into SQ before all subsequent loads are dispatched.
                // This policy ensures loads only stall on truly-dependent stores.
-               LSU.store_addr(cycle, actual->a_addr, PAY.buf[index].SQ_index, PAY.buf[index].LQ_index, PAY.buf[index].LQ_phase);
+               LSU.store_addr(cycle, actual->a_addr, PAY.hot(index).SQ_index, PAY.hot(index).LQ_index, PAY.hot(index).LQ_phase);
             }
          }
       }
 
       // Checkpointed branches must record information for restoring the LQ/SQ when a branch misprediction resolves.
-      if (PAY.buf[index].checkpoint) {
-         LSU.checkpoint(PAY.buf[index].LQ_index, PAY.buf[index].LQ_phase, PAY.buf[index].SQ_index, PAY.buf[index].SQ_phase);
+      if (PAY.hot(index).checkpoint) {
+         LSU.checkpoint(PAY.hot(index).LQ_index, PAY.hot(index).LQ_phase, PAY.hot(index).SQ_index, PAY.hot(index).SQ_phase);
       }
    }
 
    // Remove the dispatch bundle from the Dispatch Stage.
    for (i = 0; i < dispatch_width; i++) {
-      assert(DISPATCH[i].valid);
+      assert(REG_VALID(DISPATCH[i]));
       DISPATCH[i].valid = false;
    }
 }
 
 
-unsigned int pipeline_t::steer(fu_type fu) {
-   unsigned int fu_lane_vector;
+unsigned int pipeline_t::steer(unsigned int index) {
+   fu_type fu = PAY.hot(index).fu;
    unsigned int lane_id;
-   unsigned int i;
-   bool found;
 
    // Choose an execution lane for the instruction based on:
    // (1) its FU type,
    // (2) the FU/lane matrix, and
-   // (3) a load balancing policy.
+   // (3) the steering policy (see lane_steer.h).
 
    assert((unsigned int)fu < (unsigned int)NUMBER_FU_TYPES);
-   fu_lane_vector = fu_lane_matrix[(unsigned int)fu];
-   lane_id = fu_lane_ptr[(unsigned int)fu];
-
+   lane_id = STEER.steer((unsigned int)fu, fu_lane_matrix[(unsigned int)fu],
+                         PAY.hot(index).A_valid, PAY.hot(index).A_phys_reg,
+                         PAY.hot(index).B_valid, PAY.hot(index).B_phys_reg);
    assert(lane_id < issue_width);
-   found = false;
-   for (i = 0; i < issue_width; i++) {
-      lane_id++;
-      if (lane_id == issue_width) {
-         lane_id = 0;
-      }
 
-      if (fu_lane_vector & (1 << lane_id)) {
-         found = true;
-         break;
+   // Record the lane of the destination's producer, for dependence-aware steering of its consumers.
+   if (PAY.hot(index).C_valid)
+      STEER.produce(PAY.hot(index).C_phys_reg, lane_id);
+
+   return(lane_id);
+}
+
+
+void pipeline_t::value_predict(unsigned int index, uint64_t branch_mask) {
+   uint64_t value;
+
+   // Eligible: instructions that execute in a lane and whose result is only a register value.
+   // Excluded: control transfers (their recovery is not value recovery), stores and atomics
+   // (memory side effects), system instructions (executed at retirement), and split instructions.
+   if ((PAY.hot(index).iq == SEL_IQ) && !PAY.hot(index).split &&
+       !IS_BRANCH(PAY.hot(index).flags) && !IS_STORE(PAY.hot(index).flags) &&
+       !IS_AMO(PAY.hot(index).flags) && !IS_CSR(PAY.hot(index).flags)) {
+      if (VP.predict(PAY.cold(index).pc, PAY.hot(index).C_phys_reg, branch_mask, value)) {
+         REN->write(PAY.hot(index).C_phys_reg, value);
+         REN->set_ready(PAY.hot(index).C_phys_reg);
       }
    }
+   else {
+      VP.no_predict(PAY.hot(index).C_phys_reg);
+   }
+}
 
-   assert(found);
-   fu_lane_ptr[(unsigned int)fu] = lane_id;
-   return(lane_id);
+
+void pipeline_t::wakeup(uint64_t tag) {
+   unsigned int i, n;
+
+   // Indexed wakeup: only the IQ entries registered on the tag's consumer list (at dispatch)
+   // are woken up, rather than broadcasting the tag to every IQ entry.
+   n = WL.wakeup(tag);
+   for (i = 0; i < n; i++) {
+      IQ.wakeup_operand(WL.get_entry(i), WL.get_operand(i));
+   }
+
+   // An early wakeup by a load predicted to hit: remember the woken consumers, so that they can be made
+   // to wait again if the load misses (see execute()).
+   if (SPEC_LOAD_WAKEUP && LHP.speculative(tag)) {
+      for (i = 0; i < n; i++)
+         LHP.record(tag, WL.get_entry(i), WL.get_operand(i));
+   }
 }
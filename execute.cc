@@ -1,48 +1,59 @@
 #include "pipeline.h"
 #include "trap.h"
+#include "trace_log.h"
+#include "timeline.h"
+#include "squash_epoch.h"
 
 
 void pipeline_t::execute(unsigned int lane_number) {
    unsigned int index;
    bool hit;		// load value available
    unsigned int depth;
+   unsigned int last;	// physical slot of the final sub-stage
+   unsigned int prev;	// physical slot of the second-to-last sub-stage
+   uint64_t cause;	// fault of an ALU-type instruction, or TRAP_NONE
 
-   // Check if there is an instruction in the final Execute Stage of the specified Execution Lane.
+   // The sub-stages of an Execution Lane form a circular buffer. Logical sub-stage 'k' lives in
+   // physical slot (ex_base + k) % ex_depth. Advancing the lane only moves ex_base, see below.
    assert(Execution_Lanes[lane_number].ex_depth > 0);
    depth = (Execution_Lanes[lane_number].ex_depth - 1);
-   if (Execution_Lanes[lane_number].ex[depth].valid) {
+   last = (Execution_Lanes[lane_number].ex_base + depth) % Execution_Lanes[lane_number].ex_depth;
+
+   // Check if there is an instruction in the final Execute Stage of the specified Execution Lane.
+   if (REG_VALID(Execution_Lanes[lane_number].ex[last])) {
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
       // Get the instruction's index into PAY.
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
-      index = Execution_Lanes[lane_number].ex[depth].index;
+      index = Execution_Lanes[lane_number].ex[last].index;
+      TIMELINE.stamp(index, TL_EXECUTE, cycle);
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
       // Execute the instruction.
       // * Load and store instructions use the AGEN and Load/Store Units.
       // * All other instructions use the ALU.
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
-      if (IS_MEM_OP(PAY.buf[index].flags)) {
+      if (IS_MEM_OP(PAY.hot(index).flags)) {
          // Perform AGEN to generate address.
-         if (!PAY.buf[index].split_store || PAY.buf[index].upper) {
+         if (!PAY.hot(index).split_store || PAY.hot(index).upper) {
             agen(index);
          }
 
          // Execute the load or store in the LSU.
  
-         if (IS_LOAD(PAY.buf[index].flags)) {
+         if (IS_LOAD(PAY.hot(index).flags)) {
             // Instruction is a load.
 
-            if (IS_AMO(PAY.buf[index].flags)) {
+            if (IS_AMO(PAY.hot(index).flags)) {
                // Set up load reservation to verifiy atomicity with a following store-conditional.
-               get_state()->load_reservation = PAY.buf[index].addr;
+               get_state()->load_reservation = PAY.cold(index).addr;
             }
 
             hit = LSU.load_addr(cycle,
-                                PAY.buf[index].addr,
-                                PAY.buf[index].LQ_index,
-                                PAY.buf[index].SQ_index, PAY.buf[index].SQ_phase,
-                                PAY.buf[index].C_value.dw);
+                                PAY.cold(index).addr,
+                                PAY.hot(index).LQ_index,
+                                PAY.hot(index).SQ_index, PAY.hot(index).SQ_phase,
+                                PAY.hot(index).C_value.dw);
 
             // FIX_ME #13
             // If the load hit:
@@ -54,7 +65,7 @@ void pipeline_t::execute(unsigned int lane_number) {
             // If it didn't hit, it will get replayed later from within the LSU ("load_replay").
             //
             // Tips:
-            // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+            // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
             // 2. Background: The code above attempts to execute the load instruction in the LSU.
             //    The load may hit (a value is obtained from either the SQ or D$) or not hit (disambiguation stall or D$ miss stall).
             //    The local variable 'hit' indicates which case occurred. Recall, since we didn't know in the Register Read Stage
@@ -69,77 +80,55 @@ void pipeline_t::execute(unsigned int lane_number) {
             //       provided by the LSU via the code above) into the Physical Register File.
             //       Note: Values in the payload use a union type (can be referenced as either a single doubleword or as two words
             //       separately); see the comments in file payload.h regarding referencing a value as a single doubleword.
+            // Speculative load-hit wakeup: if the load woke up its dependents early but missed, undo the wakeup.
+            if (SPEC_LOAD_WAKEUP && PAY.hot(index).C_valid && LHP.resolve(PAY.cold(index).pc, PAY.hot(index).C_phys_reg, hit))
+               spec_load_miss(index);
+
             if(hit)
             {
-               IQ.wakeup(PAY.buf[index].C_phys_reg);
-               REN->set_ready(PAY.buf[index].C_phys_reg);
-               REN->write(PAY.buf[index].C_phys_reg, PAY.buf[index].C_value.dw);
+               wakeup(PAY.hot(index).C_phys_reg);
+               REN->set_ready(PAY.hot(index).C_phys_reg);
+               REN->write(PAY.hot(index).C_phys_reg, PAY.hot(index).C_value.dw);
+
+               if (VALUE_PRED)
+                  value_verify(index);
             }
 
 
          }
          else {
             // Instruction is a store
-            assert(IS_STORE(PAY.buf[index].flags));
+            assert(IS_STORE(PAY.hot(index).flags));
 
-            if (PAY.buf[index].split_store) {
-               assert(PAY.buf[index].split);
-               if (PAY.buf[index].upper)
-                  LSU.store_addr(cycle, PAY.buf[index].addr, PAY.buf[index].SQ_index, PAY.buf[index].LQ_index, PAY.buf[index].LQ_phase);    // upper op: address
+            if (PAY.hot(index).split_store) {
+               assert(PAY.hot(index).split);
+               if (PAY.hot(index).upper)
+                  LSU.store_addr(cycle, PAY.cold(index).addr, PAY.hot(index).SQ_index, PAY.hot(index).LQ_index, PAY.hot(index).LQ_phase);    // upper op: address
                else
-                  LSU.store_value(PAY.buf[index].SQ_index, PAY.buf[index].A_value.dw);    // lower op: value
+                  LSU.store_value(PAY.hot(index).SQ_index, PAY.hot(index).A_value.dw);    // lower op: value
             }
             else {
                // If not a split-store, then the store has both the address and the value.
-               LSU.store_addr(cycle, PAY.buf[index].addr, PAY.buf[index].SQ_index, PAY.buf[index].LQ_index, PAY.buf[index].LQ_phase);
-               LSU.store_value(PAY.buf[index].SQ_index, PAY.buf[index].B_value.dw);
+               LSU.store_addr(cycle, PAY.cold(index).addr, PAY.hot(index).SQ_index, PAY.hot(index).LQ_index, PAY.hot(index).LQ_phase);
+               LSU.store_value(PAY.hot(index).SQ_index, PAY.hot(index).B_value.dw);
             }
 
             // Store-conditional: write 0 to its destination register anticipating a success.
-            if (IS_AMO(PAY.buf[index].flags)) {
-               assert(PAY.buf[index].C_valid);
-               assert(PAY.buf[index].C_log_reg != 0);  // if X0, would have cleared C_valid in Decode Stage
-               PAY.buf[index].C_value.dw = 0;
-               REN->write(PAY.buf[index].C_phys_reg, 0);
+            if (IS_AMO(PAY.hot(index).flags)) {
+               assert(PAY.hot(index).C_valid);
+               assert(PAY.cold(index).C_log_reg != 0);  // if X0, would have cleared C_valid in Decode Stage
+               PAY.hot(index).C_value.dw = 0;
+               REN->write(PAY.hot(index).C_phys_reg, 0);
             }
          }
       }
       else {
          // Execute the ALU-type instruction on the ALU.
-         try {
-            alu(index);
-         }
-         // Catch exceptions thrown by the ALU.
-         catch (trap_t *t) {
-            unsigned int al_index = PAY.buf[index].AL_index;
-            reg_t epc = PAY.buf[index].pc;
-            ifprintf(logging_on,execute_log, "Cycle %" PRIcycle ": core %3d: exception %s, epc 0x%016" PRIx64 " al_index %u\n", cycle, id, t->name(), epc, al_index);
-            REN->set_exception(al_index);
-            PAY.buf[index].trap = t;
-         }
-         // Catch reference types thrown from unknown source outside micro sim.
-         catch (trap_t& t){
-            unsigned int al_index = PAY.buf[index].AL_index;
-            reg_t epc = PAY.buf[index].pc;
-            ifprintf(logging_on,execute_log, "Cycle %" PRIcycle ": core %3d: exception refernce thrown from unknown source %s, epc 0x%016" PRIx64 " al_index %u\n", cycle, id, t.name(), epc, al_index);
-            trap_t *tp;
-            switch(t.cause()){
-               case CAUSE_FP_DISABLED:
-                  tp = new trap_fp_disabled();
-                  break;
-               case CAUSE_ILLEGAL_INSTRUCTION:
-                  tp = new trap_illegal_instruction();
-                  break;
-               case CAUSE_PRIVILEGED_INSTRUCTION:
-                  tp = new trap_privileged_instruction();
-                  break;
-               default:
-                  fflush(0);
-                  assert(0);
-                  break;
-            }
-            REN->set_exception(al_index);
-            PAY.buf[index].trap = tp;
+         // A fault is returned as a status (see execute_alu()), and recorded in the Active List and the payload.
+         cause = execute_alu(index);
+         if (cause != TRAP_NONE) {
+            REN->set_exception(PAY.hot(index).AL_index);
+            PAY.cold(index).trap.post(cause);
          }
 
          // FIX_ME #14
@@ -148,15 +137,18 @@ void pipeline_t::execute(unsigned int lane_number) {
          // Doing this here, instead of in WB, properly simulates the bypass network.
          //
          // Tips:
-         // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+         // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
          // 2. If the ALU type instruction has a destination register, then write the doubleword value of the
          //    destination register (now available in the instruction's payload, which was provided by alu()
          //    via the code above) into the Physical Register File.
          //    Note: Values in the payload use a union type (can be referenced as either a single doubleword or as two words
          //    separately); see the comments in file payload.h regarding referencing a value as a single doubleword.
-         if(PAY.buf[index].C_valid)
+         if(PAY.hot(index).C_valid)
          {
-            REN->write(PAY.buf[index].C_phys_reg, PAY.buf[index].C_value.dw);
+            REN->write(PAY.hot(index).C_phys_reg, PAY.hot(index).C_value.dw);
+
+            if (VALUE_PRED)
+               value_verify(index);
          }
 
 
@@ -172,27 +164,28 @@ void pipeline_t::execute(unsigned int lane_number) {
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
       // There must be space in the Writeback Stage because Execution Lanes are free-flowing.
-      assert(!Execution_Lanes[lane_number].wb.valid);
+      assert(!REG_VALID(Execution_Lanes[lane_number].wb));
 
       // Copy instruction to Writeback Stage.
       // BUT: Stalled loads should not advance to the Writeback Stage.
-      if (!IS_LOAD(PAY.buf[index].flags) || hit) {
-         Execution_Lanes[lane_number].wb.valid = true;
-         Execution_Lanes[lane_number].wb.index = Execution_Lanes[lane_number].ex[depth].index;
-         Execution_Lanes[lane_number].wb.branch_mask = Execution_Lanes[lane_number].ex[depth].branch_mask;
+      if (!IS_LOAD(PAY.hot(index).flags) || hit) {
+         REG_SET_VALID(Execution_Lanes[lane_number].wb);
+         Execution_Lanes[lane_number].wb.index = Execution_Lanes[lane_number].ex[last].index;
+         Execution_Lanes[lane_number].wb.branch_mask = Execution_Lanes[lane_number].ex[last].branch_mask;
       }
 
       // Remove instruction from Execute Stage.
-      Execution_Lanes[lane_number].ex[depth].valid = false;
+      Execution_Lanes[lane_number].ex[last].valid = false;
    }
 
    if (depth > 0) {
       // This is a multi-cycle execution lane.
       // "depth" corresponds to the instruction in the last sub-stage (and was handled above).
       // "depth-1" corresponds to instruction in second-to-last sub-stage.
+      prev = (Execution_Lanes[lane_number].ex_base + depth - 1) % Execution_Lanes[lane_number].ex_depth;
       
-      if (Execution_Lanes[lane_number].ex[depth-1].valid) {
-	 index = Execution_Lanes[lane_number].ex[depth-1].index;
+      if (REG_VALID(Execution_Lanes[lane_number].ex[prev])) {
+	 index = Execution_Lanes[lane_number].ex[prev].index;
          // FIX_ME #11b
          //
          // The check, above, indicates that there is a valid instruction in the
@@ -204,79 +197,334 @@ void pipeline_t::execute(unsigned int lane_number) {
          // (2) Set the corresponding ready bit in the Physical Register File Ready Bit Array.
 	 //
          // Tips:
-         // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+         // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
          // 2. The easiest way to tell if this instruction is a load or not, is to test the instruction's
          //    flags (in its payload) via the IS_LOAD() macro (see pipeline.h).
          // 3. If the instruction has a destination register AND it is not a load, then:
          //    a. Wakeup dependents in the IQ using its wakeup() port (see issue_queue.h for arguments
          //       to the wakeup port).
          //    b. Set the destination register's ready bit.
-         if((!IS_LOAD(PAY.buf[index].flags)) && (PAY.buf[index].C_valid))
+         if((PAY.hot(index).C_valid) && (!IS_LOAD(PAY.hot(index).flags) || spec_load_wakeup(index)))
       {
-         IQ.wakeup(PAY.buf[index].C_phys_reg);
-         REN->set_ready(PAY.buf[index].C_phys_reg);
+         wakeup(PAY.hot(index).C_phys_reg);
+         REN->set_ready(PAY.hot(index).C_phys_reg);
       }
       }
    }
 
    // Advance instructions that are in-flight within the Execution Lane.
-   while (depth > 0) {
-      if (Execution_Lanes[lane_number].ex[depth-1].valid) {
-         // There must be space in the next sub-stage.
-         assert(!Execution_Lanes[lane_number].ex[depth].valid);
-
-         // Copy instruction from [depth-1] sub-stage to [depth] sub-stage.
-         Execution_Lanes[lane_number].ex[depth].valid = true;
-         Execution_Lanes[lane_number].ex[depth].index = Execution_Lanes[lane_number].ex[depth-1].index;
-         Execution_Lanes[lane_number].ex[depth].branch_mask = Execution_Lanes[lane_number].ex[depth-1].branch_mask;
-
-         // Remove instruction from [depth-1] sub-stage.
-         Execution_Lanes[lane_number].ex[depth-1].valid = false;
+   // Rotating the base by one slot moves every logical sub-stage 'k' to 'k+1' in O(1).
+   // The final sub-stage was just vacated above, so its slot becomes the new first sub-stage
+   // and is free for the instruction coming from the Register Read Stage.
+   if (depth > 0) {
+      assert(!REG_VALID(Execution_Lanes[lane_number].ex[last]));
+      Execution_Lanes[lane_number].ex_base = last;
+   }
+}
+
+uint64_t pipeline_t::execute_alu(unsigned int index) {
+   uint64_t cause;
+
+   // Execute an ALU-type instruction. Returns the cause of its fault, or TRAP_NONE.
+
+   // An FP instruction that faulted in the Dispatch Stage (FP extension absent or disabled) would only fault
+   // again in the ALU, with the same cause: don't execute it. Its trap was already recorded.
+   if (REN->get_exception(PAY.hot(index).AL_index))
+      return(TRAP_NONE);
+
+   if (IS_CSR(PAY.hot(index).flags) && renamed_csr_read(index)) {
+      execute_csr_read(index);
+      return(TRAP_NONE);
+   }
+
+   // The ISA's instruction implementations, called by alu(), still signal faults by throwing.
+   // Only the FP faults above are detected ahead of alu(). Any other illegal-instruction or
+   // privileged-instruction fault still unwinds through alu() and is converted to a status here.
+   try {
+      alu(index);
+   }
+   // Catch exceptions thrown by the ALU.
+   catch (trap_t *t) {
+      if (TRACE_ON(TRACE_EVENTS))
+         ifprintf(logging_on,execute_log, "Cycle %" PRIcycle ": core %3d: exception %s, epc 0x%016" PRIx64 " al_index %u\n", cycle, id, t->name(), PAY.cold(index).pc, PAY.hot(index).AL_index);
+      TRACE(TRACE_EVENTS, TRACE_EV_EXCEPTION, id, cycle, PAY.cold(index).sequence, PAY.cold(index).pc, t->cause());
+      cause = t->cause();
+      delete t;
+      return(cause);
+   }
+   // Catch reference types thrown from unknown source outside micro sim.
+   catch (trap_t& t) {
+      if (TRACE_ON(TRACE_EVENTS))
+         ifprintf(logging_on,execute_log, "Cycle %" PRIcycle ": core %3d: exception refernce thrown from unknown source %s, epc 0x%016" PRIx64 " al_index %u\n", cycle, id, t.name(), PAY.cold(index).pc, PAY.hot(index).AL_index);
+      TRACE(TRACE_EVENTS, TRACE_EV_EXCEPTION_EXTERNAL, id, cycle, PAY.cold(index).sequence, PAY.cold(index).pc, t.cause());
+      switch (t.cause()) {
+         case CAUSE_FP_DISABLED:
+         case CAUSE_ILLEGAL_INSTRUCTION:
+         case CAUSE_PRIVILEGED_INSTRUCTION:
+            break;
+         default:
+            fflush(0);
+            assert(0);
+            break;
       }
-      depth--;
+      return(t.cause());
+   }
+
+   return(TRAP_NONE);
+}
+
+bool pipeline_t::renamed_csr_read(unsigned int index) {
+   insn_t inst = PAY.cold(index).inst;
+
+   // Renamed CSR reads (RENAMED_CSR_READS): a CSR instruction that only reads a side-effect-free CSR
+   // does not need to serialize the pipeline. It is renamed like any other instruction and executes
+   // speculatively in its Execution Lane (execute_csr_read()); all other CSR instructions keep the
+   // serialize-and-squash path through execute_csr() at retirement.
+   if (!RENAMED_CSR_READS)
+      return(false);
+
+   // Read-only forms: CSRRS/CSRRC with rs1 = x0, CSRRSI/CSRRCI with a zero immediate.
+   switch (inst.funct3()) {
+      case FN3_SET:
+      case FN3_CLR:
+      case FN3_SET_IMM:
+      case FN3_CLR_IMM:
+         if (PAY.cold(index).A_log_reg != 0)
+            return(false);
+         break;
+      default:
+         return(false);
+   }
+
+   // Only CSRs whose value cannot change while the read is in flight qualify.
+   // FRM is written only by CSR instructions, which serialize: any older write has retired before this
+   // read is fetched. The same holds for the FP enable in the status register, which is checked here
+   // so that the read cannot fault.
+   // The counters (CYCLE, TIME, INSTRET) are excluded: read at execute, they would differ from their
+   // value at retirement, which is what the functional simulator (and the checker) see.
+   // FFLAGS and FCSR are excluded: FP instructions accumulate their flags.
+   switch (PAY.cold(index).CSR_addr) {
+      case CSR_FRM:
+         return((get_state()->sr & SR_EF) != 0);
+      default:
+         return(false);
    }
 }
 
+void pipeline_t::execute_csr_read(unsigned int index) {
+   // Execute a renamed CSR read (see renamed_csr_read()) in the Execute Stage.
+   // renamed_csr_read() already checked that the CSR is accessible,
+   // so validate_csr() cannot fault (or request serialization) for it and is skipped.
+   // The result (the CSR's value) is written into the destination register by the caller.
+   assert(PAY.cold(index).A_log_reg == 0);
+   PAY.hot(index).C_value.dw = get_pcr(PAY.cold(index).CSR_addr);
+}
+
+bool pipeline_t::spec_load_wakeup(unsigned int index) {
+   // A load may wake up its dependents at the same point as other producers (as if it had a fixed
+   // hit latency) if speculative load-hit wakeup is enabled and the load is predicted to hit.
+   // Atomics are excluded: they set up a load reservation.
+   return (SPEC_LOAD_WAKEUP && !IS_AMO(PAY.hot(index).flags) &&
+           LHP.predict(PAY.cold(index).pc, PAY.hot(index).C_phys_reg));
+}
+
+void pipeline_t::spec_load_miss(unsigned int index) {
+   uint64_t tag = PAY.hot(index).C_phys_reg;
+   uint64_t branch_mask;
+   unsigned int i, n;
+
+   // A value-predicted destination was made ready at dispatch, with the predicted value: its consumers
+   // did not depend on the early wakeup, and value_verify() checks the value when the load completes.
+   if (VALUE_PRED && VP.predicted(tag)) {
+      LHP.take_consumers(tag);
+      return;
+   }
+
+   // Roll back the destination's ready bit. Dependents that already issued find it not ready in the
+   // Register Read Stage and replay from there.
+   REN->clear_ready(tag);
+
+   // Dependents still in the IQ had their operand marked ready by the early wakeup (and were taken off
+   // the wakeup list). Make them wait again, and put them back on the wakeup list, so that they do not
+   // issue until load_replay() wakes them up for real. IQ.unwake_operand() returns 'false' if the entry
+   // no longer waits on 'tag' in that operand (e.g., it issued or was squashed).
+   n = LHP.take_consumers(tag);
+   for (i = 0; i < n; i++) {
+      if (IQ.unwake_operand(LHP.get_entry(i), LHP.get_operand(i), tag, branch_mask)) {
+         WL.add(tag, LHP.get_entry(i), LHP.get_operand(i), branch_mask);
+         LHP.count_rearmed();
+      }
+   }
+}
+
+void pipeline_t::value_verify(unsigned int index) {
+   // The actual result was just written into the destination register, overwriting any predicted value.
+   // If the value was predicted wrongly, consumers may have used the wrong value: flag the instruction so
+   // that the Retire Stage squashes everything after it when it commits ("approach #1 recovery").
+   if (VP.verify(PAY.cold(index).pc, PAY.hot(index).C_phys_reg, PAY.hot(index).C_value.dw))
+      REN->set_value_misprediction(PAY.hot(index).AL_index);
+}
+
 void pipeline_t::load_replay() {
    //////////////////////////////
    // FIX_ME #18
    // Replay stalled loads.
    //
-   // There is an autonomous engine that replays one stalled load each cycle in the LSU,
-   // to determine if it can unstall. The code, below, implements the autonomous replay engine.
-   // If the replay succeeds, it means the load finally has a value and we can
+   // There is an autonomous engine that replays up to 'load_replay_ports' stalled loads each cycle
+   // in the LSU, to determine if they can unstall. The code, below, implements the autonomous replay engine.
+   // If a replay succeeds, it means the load finally has a value and we can
    // (1) wakeup its dependents,
    // (2) set the ready bit of its destination register, and
    // (3) write its value into the Physical Register File.
    // We already did these three steps for loads that hit on the first attempt;
    // here we are doing them for loads that stalled and have finally become unstalled.
+   // Each port models one PRF write port and one wakeup port for replayed loads.
    //////////////////////////////
 
    unsigned int index;
    reg_t value;
-   if (LSU.load_unstall(cycle, index, value)) {
+   unsigned int port;
+
+   // Don't ask the LSU to search for a replayable load in cycles in which none can unstall
+   // (the common case while misses are outstanding).
+   if (LSU.next_unstall_cycle(cycle) > cycle)
+      return;
+
+   for (port = 0; port < load_replay_ports; port++) {
+      if (!LSU.load_unstall(cycle, index, value))
+         break;	// no more loads can unstall this cycle
+
       // Load has resolved.
-      assert(IS_LOAD(PAY.buf[index].flags));
-      assert(PAY.buf[index].C_valid);
-      PAY.buf[index].C_value.dw = value;
+      assert(IS_LOAD(PAY.hot(index).flags));
+      assert(PAY.hot(index).C_valid);
+      PAY.hot(index).C_value.dw = value;
 
       // FIX_ME #18a
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. See #13 (in execute.cc), and implement steps 3a,3b,3c.
-      IQ.wakeup(PAY.buf[index].C_phys_reg);
-      REN->set_ready(PAY.buf[index].C_phys_reg);
-      REN->write(PAY.buf[index].C_phys_reg, PAY.buf[index].C_value.dw);
+      wakeup(PAY.hot(index).C_phys_reg);
+      REN->set_ready(PAY.hot(index).C_phys_reg);
+      REN->write(PAY.hot(index).C_phys_reg, PAY.hot(index).C_value.dw);
+
+      if (VALUE_PRED)
+         value_verify(index);
 
 
       // FIX_ME #18b
       // Set completed bit in Active List.
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. Set the completed bit for this instruction in the Active List.
-      REN->set_complete(PAY.buf[index].AL_index);
+      REN->set_complete(PAY.hot(index).AL_index);
+   }
+}
+
+void pipeline_t::skip_idle_cycles() {
+   //////////////////////////////
+   // Event-driven idle-cycle skipping.
+   //
+   // When the whole pipeline is stalled waiting on memory, stepping every stage each cycle
+   // changes nothing. Detect that case and jump 'cycle' forward to the cycle just before the
+   // next event that can change state, so that the next step of the pipeline is that event.
+   //
+   // The pipeline is idle if all of the following hold:
+   // (1) Every Execution Lane is empty (Register Read, Execute and Writeback Stages).
+   // (2) The IQ has no instruction that can issue.
+   // (3) The Active List head, if any, is not completed (nothing can retire).
+   // (4) The Dispatch Stage holds a bundle that is stalled on the Active List, the IQ (full, and
+   //     by (2) nothing in it can issue), or the LQ/SQ, and the Rename Stage behind it is backed up.
+   // (5) The frontend cannot make progress: the Decode Stage is empty or backed up behind a full
+   //     FQ, and the Fetch Unit is waiting for next_fetch_cycle or is blocked by the Decode Stage.
+   //
+   // The next-event sources are the completion of an LSU miss (load_replay() unstalls a load)
+   // and next_fetch_cycle.
+   //
+   // The skipped cycles are added to idle_cycles, and to the per-cycle stall counts of the
+   // Dispatch Stage, which would have stalled in each of them.
+   //////////////////////////////
+
+   unsigned int i, j;
+   unsigned int index;
+   unsigned int bundle_inst, bundle_load, bundle_store;
+   bool head_valid;
+   bool completed, exception, load_viol, br_misp, val_misp, load, store, branch, amo, csr;
+   reg_t head_PC;
+   cycle_t next_event;
+   cycle_t skipped;
+
+   // (1) Every Execution Lane is empty.
+   for (i = 0; i < issue_width; i++) {
+      if (REG_VALID(Execution_Lanes[i].rr) || REG_VALID(Execution_Lanes[i].wb))
+         return;
+      for (j = 0; j < Execution_Lanes[i].ex_depth; j++) {
+         if (REG_VALID(Execution_Lanes[i].ex[j]))
+            return;
+      }
+   }
+
+   // (2) Nothing in the IQ can issue.
+   if (IQ.any_ready())
+      return;
+
+   // (3) Nothing can retire.
+   head_valid = REN->precommit(completed, exception, load_viol, br_misp, val_misp, load, store, branch, amo, csr, head_PC);
+   if (head_valid && completed)
+      return;
+
+   // (4) The Dispatch Stage is stalled on the Active List, the IQ or the LQ/SQ, and Rename is backed
+   //     up behind it. The IQ and LQ/SQ requirements are counted as in dispatch().
+   if (!REG_VALID(DISPATCH[0]) || !REG_VALID(RENAME2[0]))
+      return;
+
+   if (!REN->stall_dispatch(dispatch_width)) {
+      bundle_inst = 0;
+      bundle_load = 0;
+      bundle_store = 0;
+      for (i = 0; i < dispatch_width; i++) {
+         index = DISPATCH[i].index;
+         if (PAY.hot(index).iq == SEL_IQ)
+            bundle_inst++;
+         if (IS_LOAD(PAY.hot(index).flags))
+            bundle_load++;
+         else if (IS_STORE(PAY.hot(index).flags) && (!PAY.hot(index).split_store || PAY.hot(index).upper))
+            bundle_store++;
+      }
+      if (!IQ.stall(bundle_inst + (SPEC_LOAD_WAKEUP ? issue_width : 0)) && !LSU.stall(bundle_load, bundle_store))
+         return;
+   }
+
+   // (5) The Decode Stage cannot move its bundle into the FQ, and the Fetch Unit cannot make
+   //     progress before next_fetch_cycle.
+   if (REG_VALID(DECODE[0]) && FQ.enough_space(fetch_width))
+      return;
+
+   next_event = LSU.next_unstall_cycle(cycle);
+   if (next_fetch_cycle > cycle) {
+      if (next_fetch_cycle < next_event)
+         next_event = next_fetch_cycle;
+   }
+   else if (!REG_VALID(DECODE[0])) {
+      return;	// Fetch can fill the Decode Stage now.
+   }
+
+   // Nothing is pending at all (e.g., deadlock): keep stepping so the usual checks catch it.
+   if (next_event == (cycle_t)(-1))
+      return;
+
+   // Jump to the cycle before the next event; the caller's increment lands on the event itself.
+   if (next_event > (cycle + 1)) {
+      skipped = next_event - cycle - 1;
+      idle_cycles += skipped;
 
+      // Per-cycle statistics: the stalled Dispatch Stage would have seen the same stall in every
+      // skipped cycle.
+      if (SHADOW.enabled())
+         SHADOW.dispatch(REN->get_active_size(), dispatch_width, skipped);
+      if (REN->stall_dispatch(dispatch_width))
+         REN->count_stall_dispatch(skipped);
 
+      cycle = next_event - 1;
    }
 }
@@ -0,0 +1,31 @@
+#include "pipeline.h"
+
+
+////////////////////////////////////////////////////////////////////////////////////
+// Fast-forward.
+//
+// The functional simulator runs the first N instructions alone. The detailed
+// pipeline then starts from the functional simulator's architectural state
+// instead of from reset: inject_arch_state() empties the pipeline, copies the
+// architectural state, and seeds the renamer's PRF so that RMT and AMT map each
+// logical register to the physical register holding its value.
+////////////////////////////////////////////////////////////////////////////////////
+
+void pipeline_t::inject_arch_state(const state_t& arch) {
+   uint64_t arch_values[NXPR + NFPR];
+   unsigned int i;
+
+   // Empty the pipeline and redirect fetch to the first instruction after the fast-forwarded region.
+   squash_complete(arch.pc);
+
+   // Copy the architectural state, including the CSRs.
+   state = arch;
+
+   // Logical registers 0 .. NXPR-1 are the integer registers and NXPR .. NXPR+NFPR-1 are the FP registers.
+   for (i = 0; i < NXPR; i++)
+      arch_values[i] = arch.XPR[i];
+   for (i = 0; i < NFPR; i++)
+      arch_values[NXPR + i] = arch.FPR[i];
+
+   REN->load_arch_state(arch_values, NXPR + NFPR);
+}
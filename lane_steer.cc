@@ -0,0 +1,285 @@
+#include "lane_steer.h"
+
+lane_steer::lane_steer(unsigned int n_fu_types, unsigned int n_lanes, uint64_t n_phys_regs, steer_policy policy)
+{
+    assert((n_lanes > 0) && (n_lanes <= 64));
+    this->n_fu_types = n_fu_types;
+    this->n_lanes = n_lanes;
+    this->policy = policy;
+
+    last_lane = new unsigned int[n_fu_types];
+    for (unsigned int f = 0; f < n_fu_types; f++)
+    {
+        ////first round-robin pick is lane 0////
+        last_lane[f] = n_lanes - 1;
+    }
+
+    occupancy = new unsigned int[n_lanes];
+    groups = new Group[n_lanes * MAX_GROUPS];
+    n_groups = new unsigned int[n_lanes];
+    stat_steered = new uint64_t[n_lanes];
+    stat_issued = new uint64_t[n_lanes];
+    for (unsigned int l = 0; l < n_lanes; l++)
+    {
+        occupancy[l] = 0;
+        n_groups[l] = 0;
+        stat_steered[l] = 0;
+        stat_issued[l] = 0;
+    }
+    stat_single_lane = 0;
+    stat_dep_hits = 0;
+
+    producer_lane = NULL;
+    resize(n_phys_regs);
+}
+
+lane_steer::~lane_steer()
+{
+    delete[] last_lane;
+    delete[] occupancy;
+    delete[] groups;
+    delete[] n_groups;
+    delete[] producer_lane;
+    delete[] stat_steered;
+    delete[] stat_issued;
+}
+
+void lane_steer::resize(uint64_t n_phys_regs)
+{
+    delete[] producer_lane;
+    this->n_phys_regs = n_phys_regs;
+    producer_lane = new unsigned int[n_phys_regs];
+    for (uint64_t p = 0; p < n_phys_regs; p++)
+    {
+        ////no producer: never a candidate////
+        producer_lane[p] = n_lanes;
+    }
+}
+
+lane_steer::Group *lane_steer::find_group(unsigned int lane, uint64_t branch_mask)
+{
+    Group *g = &groups[lane * MAX_GROUPS];
+
+    ////the youngest instructions' mask is usually the last one added////
+    for (unsigned int i = n_groups[lane]; i > 0; i--)
+    {
+        if (g[i - 1].branch_mask == branch_mask)
+            return &g[i - 1];
+    }
+    return NULL;
+}
+
+void lane_steer::remove_group(unsigned int lane, unsigned int i)
+{
+    Group *g = &groups[lane * MAX_GROUPS];
+
+    assert(i < n_groups[lane]);
+    g[i] = g[n_groups[lane] - 1];
+    n_groups[lane]--;
+}
+
+void lane_steer::enter(unsigned int lane, uint64_t branch_mask)
+{
+    assert(lane < n_lanes);
+    Group *g = find_group(lane, branch_mask);
+    if (g == NULL)
+    {
+        assert(n_groups[lane] < MAX_GROUPS);
+        g = &groups[lane * MAX_GROUPS + n_groups[lane]];
+        g->branch_mask = branch_mask;
+        g->count = 0;
+        n_groups[lane]++;
+    }
+    g->count++;
+    occupancy[lane]++;
+}
+
+void lane_steer::issue(unsigned int lane, uint64_t branch_mask)
+{
+    assert(lane < n_lanes);
+    Group *g = find_group(lane, branch_mask);
+    assert(g && (g->count > 0) && (occupancy[lane] > 0));
+    g->count--;
+    occupancy[lane]--;
+    if (g->count == 0)
+        remove_group(lane, (unsigned int)(g - &groups[lane * MAX_GROUPS]));
+    stat_issued[lane]++;
+}
+
+void lane_steer::clear_branch_mask(uint64_t resolved_mask)
+{
+    for (unsigned int l = 0; l < n_lanes; l++)
+    {
+        Group *g = &groups[l * MAX_GROUPS];
+        for (unsigned int i = 0; i < n_groups[l]; i++)
+        {
+            g[i].branch_mask &= ~resolved_mask;
+        }
+
+        ////groups that now have the same mask are merged////
+        for (unsigned int i = 0; i < n_groups[l]; i++)
+        {
+            unsigned int j = i + 1;
+            while (j < n_groups[l])
+            {
+                if (g[j].branch_mask == g[i].branch_mask)
+                {
+                    g[i].count += g[j].count;
+                    remove_group(l, j);
+                }
+                else
+                {
+                    j++;
+                }
+            }
+        }
+    }
+}
+
+void lane_steer::squash(uint64_t branch_ID)
+{
+    for (unsigned int l = 0; l < n_lanes; l++)
+    {
+        Group *g = &groups[l * MAX_GROUPS];
+        unsigned int i = 0;
+        while (i < n_groups[l])
+        {
+            if (g[i].branch_mask & (1ULL << branch_ID))
+            {
+                assert(occupancy[l] >= g[i].count);
+                occupancy[l] -= g[i].count;
+                remove_group(l, i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+}
+
+void lane_steer::flush()
+{
+    for (unsigned int l = 0; l < n_lanes; l++)
+    {
+        occupancy[l] = 0;
+        n_groups[l] = 0;
+    }
+}
+
+unsigned int lane_steer::round_robin(uint64_t lane_vector, unsigned int last)
+{
+    ////first candidate after the last pick, wrapping around////
+    uint64_t after = lane_vector & above(last);
+    return (unsigned int)__builtin_ctzll(after ? after : lane_vector);
+}
+
+unsigned int lane_steer::least_loaded(uint64_t lane_vector, unsigned int last)
+{
+    ////visit candidates after the last pick first, so that ties rotate////
+    uint64_t after = lane_vector & above(last);
+    uint64_t order[2] = {after, lane_vector & ~after};
+    unsigned int best = n_lanes;
+
+    for (unsigned int pass = 0; pass < 2; pass++)
+    {
+        uint64_t v = order[pass];
+        while (v)
+        {
+            unsigned int l = (unsigned int)__builtin_ctzll(v);
+            if ((best == n_lanes) || (occupancy[l] < occupancy[best]))
+                best = l;
+            v &= (v - 1);
+        }
+    }
+    return best;
+}
+
+unsigned int lane_steer::steer(unsigned int fu, uint64_t lane_vector,
+                               bool A_valid, uint64_t A_phys_reg,
+                               bool B_valid, uint64_t B_phys_reg)
+{
+    unsigned int lane;
+
+    assert(fu < n_fu_types);
+    lane_vector &= ((n_lanes == 64) ? ~0ULL : ((1ULL << n_lanes) - 1));
+    assert(lane_vector);
+
+    if (__builtin_popcountll(lane_vector) == 1)
+    {
+        lane = (unsigned int)__builtin_ctzll(lane_vector);
+        stat_single_lane++;
+    }
+    else
+    {
+        switch (policy)
+        {
+            case STEER_ROUND_ROBIN:
+                lane = round_robin(lane_vector, last_lane[fu]);
+                break;
+
+            case STEER_DEPENDENCE:
+            {
+                ////producers' lanes that have the FU////
+                uint64_t near = 0;
+                if (A_valid)
+                {
+                    assert(A_phys_reg < n_phys_regs);
+                    if (producer_lane[A_phys_reg] < n_lanes)
+                        near |= (1ULL << producer_lane[A_phys_reg]);
+                }
+                if (B_valid)
+                {
+                    assert(B_phys_reg < n_phys_regs);
+                    if (producer_lane[B_phys_reg] < n_lanes)
+                        near |= (1ULL << producer_lane[B_phys_reg]);
+                }
+                near &= lane_vector;
+
+                if (near)
+                {
+                    lane = least_loaded(near, last_lane[fu]);
+                    stat_dep_hits++;
+                }
+                else
+                {
+                    lane = least_loaded(lane_vector, last_lane[fu]);
+                }
+                break;
+            }
+
+            case STEER_LEAST_LOADED:
+            default:
+                lane = least_loaded(lane_vector, last_lane[fu]);
+                break;
+        }
+    }
+
+    assert(lane < n_lanes);
+    last_lane[fu] = lane;
+    stat_steered[lane]++;
+    return lane;
+}
+
+void lane_steer::dump_stats(FILE *fp, uint64_t cycles)
+{
+    static const char *name[] = {"round-robin", "least-loaded", "dependence-aware"};
+    uint64_t total = 0;
+
+    for (unsigned int l = 0; l < n_lanes; l++)
+    {
+        total += stat_steered[l];
+    }
+
+    fprintf(fp, "LANE STEER: policy = %s\n", name[policy]);
+    fprintf(fp, "LANE STEER: steered = %" PRIu64 ", single-lane FU = %" PRIu64 ", steered to a producer's lane = %" PRIu64 "\n",
+            total, stat_single_lane, stat_dep_hits);
+    for (unsigned int l = 0; l < n_lanes; l++)
+    {
+        fprintf(fp, "LANE STEER: lane %u: steered = %" PRIu64 " (%.2f%%), issued = %" PRIu64 ", utilization = %.2f%%\n",
+                l, stat_steered[l],
+                (total ? 100.0*(double)stat_steered[l]/(double)total : 0.0),
+                stat_issued[l],
+                (cycles ? 100.0*(double)stat_issued[l]/(double)cycles : 0.0));
+    }
+}
@@ -0,0 +1,138 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+/////////////////////////////////////////////////////////////////////
+// Lane steering policies.
+/////////////////////////////////////////////////////////////////////
+enum steer_policy {
+	STEER_ROUND_ROBIN = 0,	// rotate among the lanes that have the FU
+	STEER_LEAST_LOADED = 1,	// lane with the fewest instructions waiting in the IQ
+	STEER_DEPENDENCE = 2	// lane of a source's producer, else least loaded
+};
+
+class lane_steer {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// Steering of instructions to execution lanes (Dispatch Stage).
+	//
+	// The candidate lanes of an instruction are the bits of its FU's
+	// lane vector (pipeline_t::fu_lane_matrix). Candidates are visited
+	// with ctz and cleared with (v & (v - 1)), one step per candidate
+	// rather than one per lane, and an FU that only exists in one lane
+	// is steered without visiting anything.
+	//
+	// Ties are broken round-robin: the visit starts after the lane that
+	// was last chosen for the FU type.
+	/////////////////////////////////////////////////////////////////////
+	steer_policy policy;
+	unsigned int n_fu_types;
+	unsigned int n_lanes;	// at most 64
+	unsigned int *last_lane;	// [n_fu_types]
+
+	/////////////////////////////////////////////////////////////////////
+	// occupancy[l]: instructions steered to lane 'l' that are waiting
+	// in the IQ. It is incremented when an instruction enters the IQ
+	// (dispatch or replay) and decremented when it reaches Register Read
+	// with its sources ready.
+	//
+	// Squashed instructions never issue, so the waiting instructions of
+	// each lane are also counted per branch mask: a selective squash
+	// removes exactly the groups whose mask has the mispredicted branch's
+	// bit, and the surviving instructions stay counted. The masks of the
+	// waiting instructions are the unresolved branches older than each
+	// one, so they are nested and there are at most one more distinct
+	// masks than there are branch bits.
+	/////////////////////////////////////////////////////////////////////
+	struct Group
+	{
+		uint64_t branch_mask;
+		unsigned int count;
+	};
+	unsigned int *occupancy;	// [n_lanes]
+	Group *groups;			// [n_lanes][MAX_GROUPS]
+	unsigned int *n_groups;		// [n_lanes]
+
+	static const unsigned int MAX_GROUPS = 65;
+
+	Group *find_group(unsigned int lane, uint64_t branch_mask);
+	void remove_group(unsigned int lane, unsigned int g);
+
+	/////////////////////////////////////////////////////////////////////
+	// producer_lane[p]: lane of the last instruction that was steered
+	// with destination physical register 'p'.
+	/////////////////////////////////////////////////////////////////////
+	unsigned int *producer_lane;
+	uint64_t n_phys_regs;
+
+	/////////////////////////////////////////////////////////////////////
+	// Statistics.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t *stat_steered;		// [n_lanes]
+	uint64_t *stat_issued;		// [n_lanes]
+	uint64_t stat_single_lane;	// FU exists in only one lane
+	uint64_t stat_dep_hits;		// steered to a producer's lane
+
+	// Candidate lanes after 'lane' (exclusive).
+	static uint64_t above(unsigned int lane) {return ((lane >= 63) ? 0 : ~((2ULL << lane) - 1));}
+
+	unsigned int round_robin(uint64_t lane_vector, unsigned int last);
+	unsigned int least_loaded(uint64_t lane_vector, unsigned int last);
+
+public:
+	/////////////////////////////////////////////////////////////////////
+	// Inputs:
+	// 1. n_fu_types: number of FU types.
+	// 2. n_lanes: number of execution lanes (issue width).
+	// 3. n_phys_regs: number of physical registers.
+	// 4. policy: initial steering policy.
+	/////////////////////////////////////////////////////////////////////
+	lane_steer(unsigned int n_fu_types, unsigned int n_lanes, uint64_t n_phys_regs, steer_policy policy);
+	~lane_steer();
+
+	void set_policy(steer_policy policy) {this->policy = policy;}
+	steer_policy get_policy() {return policy;}
+
+	/////////////////////////////////////////////////////////////////////
+	// Choose a lane among the set bits of 'lane_vector' for an
+	// instruction of FU type 'fu'. Its source physical registers, if
+	// valid, guide the dependence-aware policy.
+	/////////////////////////////////////////////////////////////////////
+	unsigned int steer(unsigned int fu, uint64_t lane_vector,
+	                   bool A_valid, uint64_t A_phys_reg,
+	                   bool B_valid, uint64_t B_phys_reg);
+
+	/////////////////////////////////////////////////////////////////////
+	// The instruction steered to 'lane' produces 'phys_reg'.
+	/////////////////////////////////////////////////////////////////////
+	void produce(uint64_t phys_reg, unsigned int lane) {
+		assert(phys_reg < n_phys_regs);
+		producer_lane[phys_reg] = lane;
+	}
+
+	/////////////////////////////////////////////////////////////////////
+	// An instruction of 'lane' with branch mask 'branch_mask' entered
+	// the IQ (dispatch or replay), or issued from it.
+	/////////////////////////////////////////////////////////////////////
+	void enter(unsigned int lane, uint64_t branch_mask);
+	void issue(unsigned int lane, uint64_t branch_mask);
+
+	/////////////////////////////////////////////////////////////////////
+	// Branch resolution: correctly-resolved branches clear their bits in
+	// the counted branch masks; a mispredicted branch uncounts the
+	// instructions that have its bit. A complete squash uncounts all.
+	/////////////////////////////////////////////////////////////////////
+	void clear_branch_mask(uint64_t resolved_mask);
+	void squash(uint64_t branch_ID);
+	void flush();
+
+	/////////////////////////////////////////////////////////////////////
+	// Change the number of physical registers (renamer reconfiguration).
+	/////////////////////////////////////////////////////////////////////
+	void resize(uint64_t n_phys_regs);
+
+	/////////////////////////////////////////////////////////////////////
+	// Per-lane utilization is reported as issued instructions per cycle.
+	/////////////////////////////////////////////////////////////////////
+	void dump_stats(FILE *fp, uint64_t cycles);
+};
@@ -0,0 +1,175 @@
+#include "load_hit_pred.h"
+
+load_hit_pred::load_hit_pred(uint64_t n_entries, uint64_t n_phys_regs, unsigned int n_iq_entries)
+{
+    assert((n_entries > 0) && ((n_entries & (n_entries - 1)) == 0));
+    this->n_entries = n_entries;
+    index_mask = n_entries - 1;
+    table = new uint8_t[n_entries];
+    for (uint64_t i = 0; i < n_entries; i++)
+    {
+        table[i] = 3;	// strongly hit: most loads hit in the L1
+    }
+
+    n_records = 3 * n_iq_entries;
+    assert(n_records > 0);
+    records = new SpecConsumer[n_records];
+    free_stack = new int[n_records];
+    taken_entry = new unsigned int[n_records];
+    taken_operand = new unsigned int[n_records];
+
+    spec_woken = NULL;
+    spec_head = NULL;
+    resize(n_phys_regs);
+
+    stat_predictions = 0;
+    stat_pred_hit = 0;
+    stat_spec_hit = 0;
+    stat_spec_miss = 0;
+    stat_replays = 0;
+    stat_rearmed = 0;
+    stat_unrecorded = 0;
+}
+
+load_hit_pred::~load_hit_pred()
+{
+    delete[] table;
+    delete[] spec_woken;
+    delete[] spec_head;
+    delete[] records;
+    delete[] free_stack;
+    delete[] taken_entry;
+    delete[] taken_operand;
+}
+
+void load_hit_pred::resize(uint64_t n_phys_regs)
+{
+    delete[] spec_woken;
+    delete[] spec_head;
+    this->n_phys_regs = n_phys_regs;
+    spec_woken = new bool[n_phys_regs];
+    spec_head = new int[n_phys_regs];
+    for (uint64_t p = 0; p < n_phys_regs; p++)
+    {
+        spec_woken[p] = false;
+        spec_head[p] = -1;
+    }
+    reset_records();
+}
+
+void load_hit_pred::reset_records()
+{
+    for (unsigned int n = 0; n < n_records; n++)
+    {
+        free_stack[n] = (int)n;
+    }
+    free_count = n_records;
+}
+
+void load_hit_pred::record(uint64_t phys_reg, unsigned int entry, unsigned int operand)
+{
+    assert(phys_reg < n_phys_regs);
+    if (free_count == 0)
+    {
+        stat_unrecorded++;
+        return;
+    }
+    free_count--;
+    int n = free_stack[free_count];
+    records[n].entry = entry;
+    records[n].operand = operand;
+    records[n].next = spec_head[phys_reg];
+    spec_head[phys_reg] = n;
+}
+
+unsigned int load_hit_pred::take_consumers(uint64_t phys_reg)
+{
+    unsigned int count = 0;
+
+    assert(phys_reg < n_phys_regs);
+    int n = spec_head[phys_reg];
+    while (n >= 0)
+    {
+        taken_entry[count] = records[n].entry;
+        taken_operand[count] = records[n].operand;
+        count++;
+
+        free_stack[free_count] = n;
+        free_count++;
+        n = records[n].next;
+    }
+    spec_head[phys_reg] = -1;
+    return count;
+}
+
+void load_hit_pred::drop_records(uint64_t phys_reg)
+{
+    assert(phys_reg < n_phys_regs);
+    int n = spec_head[phys_reg];
+    while (n >= 0)
+    {
+        free_stack[free_count] = n;
+        free_count++;
+        n = records[n].next;
+    }
+    spec_head[phys_reg] = -1;
+}
+
+bool load_hit_pred::predict(uint64_t pc, uint64_t phys_reg)
+{
+    assert(phys_reg < n_phys_regs);
+    stat_predictions++;
+    if (table[get_index(pc)] < 2)
+        return false;
+
+    stat_pred_hit++;
+    spec_woken[phys_reg] = true;
+    drop_records(phys_reg);
+    return true;
+}
+
+bool load_hit_pred::resolve(uint64_t pc, uint64_t phys_reg, bool hit)
+{
+    assert(phys_reg < n_phys_regs);
+    uint8_t &ctr = table[get_index(pc)];
+    if (hit)
+    {
+        if (ctr < 3) ctr++;
+    }
+    else
+    {
+        if (ctr > 0) ctr--;
+    }
+
+    ////a flag left behind by a squashed load is harmless: it is cleared here////
+    bool woken = spec_woken[phys_reg];
+    spec_woken[phys_reg] = false;
+    if (!woken)
+    {
+        drop_records(phys_reg);
+        return false;
+    }
+
+    if (hit)
+    {
+        ////the early wakeup was right: its consumers stay woken////
+        stat_spec_hit++;
+        drop_records(phys_reg);
+        return false;
+    }
+    stat_spec_miss++;
+    return true;
+}
+
+void load_hit_pred::dump_stats(FILE *fp)
+{
+    fprintf(fp, "LOAD HIT PRED: entries = %" PRIu64 "\n", n_entries);
+    fprintf(fp, "LOAD HIT PRED: predictions = %" PRIu64 ", predicted hit = %" PRIu64 " (%.2f%%)\n",
+            stat_predictions, stat_pred_hit,
+            (stat_predictions ? 100.0*(double)stat_pred_hit/(double)stat_predictions : 0.0));
+    fprintf(fp, "LOAD HIT PRED: early wakeups that hit = %" PRIu64 "\n", stat_spec_hit);
+    fprintf(fp, "LOAD HIT PRED: early wakeups that missed (ready bit rolled back) = %" PRIu64 "\n", stat_spec_miss);
+    fprintf(fp, "LOAD HIT PRED: replayed instructions = %" PRIu64 "\n", stat_replays);
+    fprintf(fp, "LOAD HIT PRED: IQ operands re-armed after a miss = %" PRIu64 ", consumers not recorded = %" PRIu64 "\n",
+            stat_rearmed, stat_unrecorded);
+}
@@ -0,0 +1,147 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+class load_hit_pred {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// Load hit predictor, for speculative load-hit wakeup.
+	//
+	// A table of 2-bit saturating counters indexed by load PC. A load
+	// predicted to hit wakes up its dependents early, as if it had a
+	// fixed hit latency. If it then misses, the ready bit of its
+	// destination register is cleared again, dependents still in the IQ
+	// are made to wait again (see pipeline_t::spec_load_miss()), and
+	// dependents that were already issued are replayed (see
+	// pipeline_t::register_read()).
+	/////////////////////////////////////////////////////////////////////
+	uint8_t *table;
+	uint64_t n_entries;	// power of two
+	uint64_t index_mask;
+
+	/////////////////////////////////////////////////////////////////////
+	// spec_woken[p]: physical register 'p' was made ready speculatively,
+	// by a load that has not executed yet.
+	/////////////////////////////////////////////////////////////////////
+	bool *spec_woken;
+	uint64_t n_phys_regs;
+
+	/////////////////////////////////////////////////////////////////////
+	// Consumers of an early-woken register.
+	//
+	// Early wakeup removes the consumers from the wakeup lists and marks
+	// their IQ operands ready. If the load then misses, the consumers
+	// that are still in the IQ must wait again, so they are recorded
+	// here, per register: those woken by the early wakeup, and those
+	// dispatched (or replayed) while the register was early-ready.
+	//
+	// The records come from a fixed pool. If it runs out, a consumer is
+	// not recorded: it issues, finds its source not ready, and replays
+	// from the Register Read Stage instead (see register_read()).
+	/////////////////////////////////////////////////////////////////////
+	struct SpecConsumer
+	{
+		unsigned int entry;	// IQ entry of the consumer
+		unsigned int operand;	// which source operand (A, B, or D)
+		int next;
+	};
+	int *spec_head;			// [n_phys_regs]: first record, or -1
+	struct SpecConsumer *records;
+	int *free_stack;
+	unsigned int n_records;
+	unsigned int free_count;
+
+	/////////////////////////////////////////////////////////////////////
+	// Consumers removed by the most recent take_consumers().
+	/////////////////////////////////////////////////////////////////////
+	unsigned int *taken_entry;
+	unsigned int *taken_operand;
+
+	/////////////////////////////////////////////////////////////////////
+	// Statistics.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t stat_predictions;
+	uint64_t stat_pred_hit;
+	uint64_t stat_spec_hit;		// woken early, and hit
+	uint64_t stat_spec_miss;	// woken early, but missed: ready bit rolled back
+	uint64_t stat_replays;		// instructions replayed from the Register Read Stage
+	uint64_t stat_rearmed;		// IQ operands made to wait again after a miss
+	uint64_t stat_unrecorded;	// consumers not recorded (pool empty)
+
+	uint64_t get_index(uint64_t pc) {return ((pc >> 2) & index_mask);}
+	void reset_records();
+	void drop_records(uint64_t phys_reg);
+
+public:
+	/////////////////////////////////////////////////////////////////////
+	// Inputs:
+	// 1. n_entries: number of counters (power of two).
+	// 2. n_phys_regs: number of physical registers.
+	// 3. n_iq_entries: number of IQ entries (sizes the consumer records,
+	//    three per entry).
+	/////////////////////////////////////////////////////////////////////
+	load_hit_pred(uint64_t n_entries, uint64_t n_phys_regs, unsigned int n_iq_entries);
+	~load_hit_pred();
+
+	/////////////////////////////////////////////////////////////////////
+	// Configuration check, for the pipeline's constructor.
+	// With speculative load-hit wakeup, the Dispatch Stage keeps
+	// 'issue_width' IQ entries free for replays, on top of room for a
+	// whole dispatch bundle. An IQ smaller than that never has room, and
+	// dispatch would stall forever:
+	//	assert(!SPEC_LOAD_WAKEUP ||
+	//	       load_hit_pred::iq_fits(iq_size, dispatch_width, issue_width));
+	/////////////////////////////////////////////////////////////////////
+	static bool iq_fits(unsigned int n_iq_entries, unsigned int dispatch_width, unsigned int issue_width) {
+		return (n_iq_entries >= dispatch_width + issue_width);
+	}
+
+	/////////////////////////////////////////////////////////////////////
+	// Predict whether the load at 'pc' hits. If it is predicted to hit,
+	// its destination register 'phys_reg' is recorded as woken early.
+	/////////////////////////////////////////////////////////////////////
+	bool predict(uint64_t pc, uint64_t phys_reg);
+
+	/////////////////////////////////////////////////////////////////////
+	// The load at 'pc' executed, with outcome 'hit'. Returns 'true' if
+	// its destination register was woken early but the load missed:
+	// the caller must clear the register's ready bit.
+	/////////////////////////////////////////////////////////////////////
+	bool resolve(uint64_t pc, uint64_t phys_reg, bool hit);
+
+	/////////////////////////////////////////////////////////////////////
+	// speculative(): 'phys_reg' is ready only because of an early wakeup.
+	// record(): operand 'operand' of IQ entry 'entry' became ready, or
+	//    was dispatched ready, because of the early wakeup of 'phys_reg'.
+	// take_consumers(): remove the records of 'phys_reg'. Returns their
+	//    number; record 'i' is then available through get_entry(i) and
+	//    get_operand(i) until the next call.
+	// allocate(): 'phys_reg' was allocated to a new producer (Dispatch
+	//    Stage): forget any early wakeup of an older, squashed producer.
+	/////////////////////////////////////////////////////////////////////
+	bool speculative(uint64_t phys_reg) {
+		assert(phys_reg < n_phys_regs);
+		return spec_woken[phys_reg];
+	}
+	void record(uint64_t phys_reg, unsigned int entry, unsigned int operand);
+	unsigned int take_consumers(uint64_t phys_reg);
+	unsigned int get_entry(unsigned int i) {return taken_entry[i];}
+	unsigned int get_operand(unsigned int i) {return taken_operand[i];}
+	void allocate(uint64_t phys_reg) {
+		assert(phys_reg < n_phys_regs);
+		spec_woken[phys_reg] = false;
+		drop_records(phys_reg);
+	}
+
+	void count_replay() {stat_replays++;}
+
+	void count_rearmed() {stat_rearmed++;}
+
+	/////////////////////////////////////////////////////////////////////
+	// Change the number of physical registers (renamer reconfiguration).
+	// All records are dropped.
+	/////////////////////////////////////////////////////////////////////
+	void resize(uint64_t n_phys_regs);
+
+	void dump_stats(FILE *fp);
+};
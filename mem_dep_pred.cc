@@ -0,0 +1,80 @@
+#include "mem_dep_pred.h"
+
+mem_dep_pred::mem_dep_pred(uint64_t n_entries, uint64_t clear_interval)
+{
+    assert((n_entries > 0) && ((n_entries & (n_entries - 1)) == 0));
+    this->n_entries = n_entries;
+    index_mask = n_entries - 1;
+    this->clear_interval = clear_interval;
+    next_clear = clear_interval;
+
+    table = new Entry[n_entries];
+    for (uint64_t i = 0; i < n_entries; i++)
+    {
+        table[i].valid = false;
+        table[i].tag = 0;
+    }
+
+    stat_lookups = 0;
+    stat_hits = 0;
+    stat_misses = 0;
+    stat_trains = 0;
+    stat_false_deps = 0;
+    stat_clears = 0;
+}
+
+mem_dep_pred::~mem_dep_pred()
+{
+    delete[] table;
+}
+
+bool mem_dep_pred::predict(uint64_t pc, uint64_t cycle)
+{
+    if (clear_interval && (cycle >= next_clear))
+    {
+        clear();
+        next_clear = cycle + clear_interval;
+    }
+
+    stat_lookups++;
+    uint64_t i = get_index(pc);
+    if (table[i].valid && (table[i].tag == get_tag(pc)))
+    {
+        stat_hits++;
+        return true;
+    }
+    else
+    {
+        stat_misses++;
+        return false;
+    }
+}
+
+void mem_dep_pred::train(uint64_t pc)
+{
+    uint64_t i = get_index(pc);
+    table[i].valid = true;
+    table[i].tag = get_tag(pc);
+    stat_trains++;
+}
+
+void mem_dep_pred::clear()
+{
+    for (uint64_t i = 0; i < n_entries; i++)
+    {
+        table[i].valid = false;
+    }
+    stat_clears++;
+}
+
+void mem_dep_pred::dump_stats(FILE *fp)
+{
+    fprintf(fp, "MDP: entries = %" PRIu64 ", clear interval = %" PRIu64 " cycles\n", n_entries, clear_interval);
+    fprintf(fp, "MDP: lookups = %" PRIu64 "\n", stat_lookups);
+    fprintf(fp, "MDP: hits (predicted dependent) = %" PRIu64 " (%.2f%%)\n", stat_hits,
+            (stat_lookups ? 100.0*(double)stat_hits/(double)stat_lookups : 0.0));
+    fprintf(fp, "MDP: misses (predicted independent) = %" PRIu64 "\n", stat_misses);
+    fprintf(fp, "MDP: trains (load violations) = %" PRIu64 "\n", stat_trains);
+    fprintf(fp, "MDP: false dependences = %" PRIu64 "\n", stat_false_deps);
+    fprintf(fp, "MDP: periodic clears = %" PRIu64 "\n", stat_clears);
+}
@@ -0,0 +1,83 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+class mem_dep_pred {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// Memory dependence predictor.
+	//
+	// A direct-mapped, tagged table indexed by load PC. An entry is
+	// allocated when a load causes a load violation (speculative memory
+	// disambiguation was wrong). A load that hits in the table is
+	// predicted dependent, i.e., it waits for all prior stores to
+	// compute their addresses.
+	//
+	// The whole table is cleared every 'clear_interval' cycles (0 means
+	// never), so that loads whose conflicts have gone away are allowed to
+	// speculate again.
+	/////////////////////////////////////////////////////////////////////
+	struct Entry
+	{
+		bool valid;
+		uint64_t tag;
+	};
+	struct Entry *table;
+	uint64_t n_entries;	// power of two
+	uint64_t index_mask;
+
+	uint64_t clear_interval;
+	uint64_t next_clear;	// cycle of the next periodic clear
+
+	/////////////////////////////////////////////////////////////////////
+	// Statistics.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t stat_lookups;
+	uint64_t stat_hits;		// predicted dependent
+	uint64_t stat_misses;		// predicted independent
+	uint64_t stat_trains;		// load violations
+	uint64_t stat_false_deps;	// predicted dependent, but no conflicting store
+	uint64_t stat_clears;
+
+	uint64_t get_index(uint64_t pc) {return((pc >> 2) & index_mask);}
+	uint64_t get_tag(uint64_t pc) {return(pc >> 2);}
+
+public:
+	/////////////////////////////////////////////////////////////////////
+	// Inputs:
+	// 1. n_entries: number of table entries (must be a power of two).
+	// 2. clear_interval: number of cycles between periodic clears of
+	//    the whole table, or 0 for a table that never forgets.
+	/////////////////////////////////////////////////////////////////////
+	mem_dep_pred(uint64_t n_entries, uint64_t clear_interval);
+	~mem_dep_pred();
+
+	/////////////////////////////////////////////////////////////////////
+	// Predict whether the load at 'pc' depends on a prior store
+	// (Dispatch Stage). Returns 'true' if predicted dependent.
+	// Also performs the periodic clear when it is due.
+	/////////////////////////////////////////////////////////////////////
+	bool predict(uint64_t pc, uint64_t cycle);
+
+	/////////////////////////////////////////////////////////////////////
+	// Train the predictor with a load violation of the load at 'pc'
+	// (Retire Stage).
+	/////////////////////////////////////////////////////////////////////
+	void train(uint64_t pc);
+
+	/////////////////////////////////////////////////////////////////////
+	// Count a load that was predicted dependent but turned out to have
+	// no conflicting prior store (reported by the LSU).
+	/////////////////////////////////////////////////////////////////////
+	void false_dependence() {stat_false_deps++;}
+
+	/////////////////////////////////////////////////////////////////////
+	// Invalidate the whole table.
+	/////////////////////////////////////////////////////////////////////
+	void clear();
+
+	/////////////////////////////////////////////////////////////////////
+	// Print statistics.
+	/////////////////////////////////////////////////////////////////////
+	void dump_stats(FILE *fp);
+};
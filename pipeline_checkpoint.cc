@@ -0,0 +1,104 @@
+#include "pipeline.h"
+#include "checkpoint_file.h"
+
+
+////////////////////////////////////////////////////////////////////////////////////
+// Pipeline checkpoint files.
+//
+// A checkpoint holds the committed state of the machine: the architectural state,
+// the memory image, and the warmed renamer and branch predictor. Saving does not
+// disturb the running simulation. The payload buffer, IQ and LSU are not saved:
+// restoring ends with a complete squash to the checkpointed PC, which flushes them
+// and rolls the restored renamer and branch predictor back to their committed
+// state, discarding whatever was in flight when the checkpoint was taken. Stores
+// only write memory when they retire, so the saved memory image is committed too.
+//
+// Each section is a page-aligned raw image in the file. Restoring maps the file
+// and copies each section into place, with no per-field parsing. The copy is not
+// free: the memory image is copied in full into the MMU's memory, so a restore
+// costs O(memsz) time and touches every page of the simulated memory, even where
+// the file has holes. The MMU owns its memory, so the image cannot be mapped in
+// its place. Restores are still much cheaper than re-warming, and independent
+// processes can restore from the same file.
+////////////////////////////////////////////////////////////////////////////////////
+
+struct pipeline_ckpt_t {
+   cycle_t cycle;
+   reg_t pc;
+   uint64_t num_insn;
+   uint64_t num_insn_split;
+};
+
+#define CKPT_MEM_CHUNK	4096
+
+bool pipeline_t::save_checkpoint(const char *path, reg_t resume_pc) {
+   checkpoint_file file;
+   uint64_t sizes[NUMBER_CKPT_SECTIONS];
+   pipeline_ckpt_t p;
+   char *mem = mmu->get_mem();
+   uint64_t memsz = mmu->get_memsz();
+
+   sizes[CKPT_SEC_PIPELINE] = sizeof(pipeline_ckpt_t);
+   sizes[CKPT_SEC_ARCH_STATE] = sizeof(state_t);
+   sizes[CKPT_SEC_RENAMER] = REN->state_size();
+   sizes[CKPT_SEC_BP] = BP.state_size();
+   sizes[CKPT_SEC_MEMORY] = memsz;
+   if (!file.create(path, sizes))
+      return false;
+
+   p.cycle = cycle;
+   p.pc = resume_pc;
+   p.num_insn = num_insn;
+   p.num_insn_split = num_insn_split;
+   memcpy(file.section(CKPT_SEC_PIPELINE), &p, sizeof(p));
+   memcpy(file.section(CKPT_SEC_ARCH_STATE), &state, sizeof(state_t));
+   REN->save_state(file.section(CKPT_SEC_RENAMER));
+   if (sizes[CKPT_SEC_BP])
+      BP.save_state(file.section(CKPT_SEC_BP));
+
+   // The new file reads as zeros: only write the chunks of memory that are not all
+   // zeros, so that the untouched part of a large memory stays a hole in the file.
+   char *image = (char *)file.section(CKPT_SEC_MEMORY);
+   for (uint64_t off = 0; off < memsz; off += CKPT_MEM_CHUNK) {
+      uint64_t n = ((memsz - off) < CKPT_MEM_CHUNK) ? (memsz - off) : CKPT_MEM_CHUNK;
+      if ((mem[off] != 0) || memcmp(&mem[off], &mem[off + 1], n - 1))
+         memcpy(&image[off], &mem[off], n);
+   }
+
+   file.close();
+   return true;
+}
+
+bool pipeline_t::restore_checkpoint(const char *path) {
+   checkpoint_file file;
+   pipeline_ckpt_t p;
+
+   if (!file.open(path))
+      return false;
+
+   // Validate every section before changing any state, so that a rejected
+   // checkpoint leaves the simulation as it was.
+   if ((file.section_size(CKPT_SEC_PIPELINE) != sizeof(pipeline_ckpt_t)) ||
+       (file.section_size(CKPT_SEC_ARCH_STATE) != sizeof(state_t)) ||
+       (file.section_size(CKPT_SEC_BP) != BP.state_size()) ||
+       (file.section_size(CKPT_SEC_MEMORY) != mmu->get_memsz()) ||
+       !REN->check_state(file.section(CKPT_SEC_RENAMER), file.section_size(CKPT_SEC_RENAMER)))
+      return false;
+
+   memcpy(&p, file.section(CKPT_SEC_PIPELINE), sizeof(p));
+   memcpy(&state, file.section(CKPT_SEC_ARCH_STATE), sizeof(state_t));
+   // O(memsz): the whole image, holes included, is copied over the MMU's memory.
+   memcpy(mmu->get_mem(), file.section(CKPT_SEC_MEMORY), file.section_size(CKPT_SEC_MEMORY));
+   REN->restore_state(file.section(CKPT_SEC_RENAMER), file.section_size(CKPT_SEC_RENAMER));
+   if (file.section_size(CKPT_SEC_BP))
+      BP.restore_state(file.section(CKPT_SEC_BP), file.section_size(CKPT_SEC_BP));
+
+   cycle = p.cycle;
+   num_insn = p.num_insn;
+   num_insn_split = p.num_insn_split;
+
+   // Empty the pipeline, discard the saved in-flight state of the renamer and
+   // branch predictor, and redirect fetch to the checkpointed PC.
+   squash_complete(p.pc);
+   return true;
+}
@@ -0,0 +1,50 @@
+#include "pipeline.h"
+#include "whatif.h"
+
+
+////////////////////////////////////////////////////////////////////////////////////
+// Re-parameterize a warmed pipeline, e.g., in a what-if child process (see whatif.h).
+//
+// The pipeline is drained first: execution resumes at 'resume_pc'. Warmed state
+// that does not depend on the changed parameters (branch predictor, caches,
+// committed register values) is kept.
+////////////////////////////////////////////////////////////////////////////////////
+
+void pipeline_t::reconfigure(const reconfig_t& rc, reg_t resume_pc) {
+   uint64_t n_phys_regs;
+   uint64_t n_branches;
+
+   squash_complete(resume_pc);
+
+   // Renamer sizes.
+   if (rc.n_phys_regs || rc.n_branches) {
+      n_phys_regs = (rc.n_phys_regs ? rc.n_phys_regs : REN->get_n_phys_regs());
+      n_branches = (rc.n_branches ? rc.n_branches : REN->get_n_branches());
+      REN->reconfigure(n_phys_regs, n_branches);
+
+      // The wakeup lists and the in-flight state of the load hit and value predictors are indexed by physical register.
+      WL.resize(n_phys_regs);
+      LHP.resize(n_phys_regs);
+      VP.resize(n_phys_regs);
+      STEER.resize(n_phys_regs);
+
+      // The shadow renamers derive their occupancy from the real renamer's size.
+      SHADOW.resize(n_phys_regs, n_branches);
+   }
+
+   // Memory disambiguation policy.
+   // The predictor's contents were trained under the old policy, so they are dropped.
+   if (rc.mem_dep_pred >= 0) {
+      MEM_DEP_PRED = (rc.mem_dep_pred != 0);
+      MDP.clear();
+   }
+   if (rc.spec_disambig >= 0) {
+      SPEC_DISAMBIG = (rc.spec_disambig != 0);
+   }
+
+   // Lane steering policy.
+   if (rc.steer_policy >= 0) {
+      assert(rc.steer_policy <= (int)STEER_DEPENDENCE);
+      STEER.set_policy((steer_policy)rc.steer_policy);
+   }
+}
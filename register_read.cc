@@ -1,15 +1,34 @@
 #include "pipeline.h"
+#include "timeline.h"
+#include "squash_epoch.h"
 
 void pipeline_t::register_read(unsigned int lane_number) {
    unsigned int index;
 
    // Check if there is an instruction in the Register Read Stage of the specified Execution Lane.
-   if (Execution_Lanes[lane_number].rr.valid) {
+   if (REG_VALID(Execution_Lanes[lane_number].rr)) {
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
       // Get the instruction's index into PAY.
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
       index = Execution_Lanes[lane_number].rr.index;
+      TIMELINE.stamp(index, TL_REG_READ, cycle);
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////
+      // Speculative load-hit wakeup: a load predicted to hit wakes up its dependents before it is known to hit.
+      // If it then misses, its destination's ready bit is cleared again (see execute.cc). A dependent that was
+      // already issued finds a not-ready source here: replay it, i.e., put it back into the IQ, before it wakes
+      // up its own dependents or reads its sources.
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////
+      if (SPEC_LOAD_WAKEUP && !sources_ready(index)) {
+         replay(lane_number);
+         return;
+      }
+
+      // The instruction has issued: one fewer waiting instruction in this lane. A replayed instruction
+      // goes back to the IQ instead, so it is neither counted as issued nor as a new waiting instruction.
+      if (PRESTEER)
+         STEER.issue(lane_number, Execution_Lanes[lane_number].rr.branch_mask);
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
       // FIX_ME #11a
@@ -24,7 +43,7 @@ void pipeline_t::register_read(unsigned int lane_number) {
       // simulator implementation, loads do NOT speculatively wakeup their dependent instructions.
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. The easiest way to tell if this instruction is a load or not, is to test the instruction's
       //    flags (in its payload) via the IS_LOAD() macro (see pipeline.h).
       // 3. The instruction's latency is provided for you as "lat" below: it's the number of
@@ -39,10 +58,10 @@ void pipeline_t::register_read(unsigned int lane_number) {
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
       unsigned int lat = Execution_Lanes[lane_number].ex_depth;
-      if((!IS_LOAD(PAY.buf[index].flags)) && (PAY.buf[index].C_valid) && (lat==1))
+      if((PAY.hot(index).C_valid) && (lat==1) && (!IS_LOAD(PAY.hot(index).flags) || spec_load_wakeup(index)))
       {
-         IQ.wakeup(PAY.buf[index].C_phys_reg);
-         REN->set_ready(PAY.buf[index].C_phys_reg);
+         wakeup(PAY.hot(index).C_phys_reg);
+         REN->set_ready(PAY.hot(index).C_phys_reg);
       }
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -50,7 +69,7 @@ void pipeline_t::register_read(unsigned int lane_number) {
       // Read source register(s) from the Physical Register File.
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. If the instruction has a first source register (A), then read its doubleword value from
       //    the Physical Register File.
       // 3. If the instruction has a second source register (B), follow the same procedure for it.
@@ -60,17 +79,17 @@ void pipeline_t::register_read(unsigned int lane_number) {
       //    as either a single doubleword or as two words separately); see the comments in file
       //    payload.h regarding referencing a value as a single doubleword.
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
-      if(PAY.buf[index].A_valid)
+      if(PAY.hot(index).A_valid)
       {
-         PAY.buf[index].A_value.dw = REN->read(PAY.buf[index].A_phys_reg);
+         PAY.hot(index).A_value.dw = REN->read(PAY.hot(index).A_phys_reg);
       }
-      if(PAY.buf[index].B_valid)
+      if(PAY.hot(index).B_valid)
       {
-         PAY.buf[index].B_value.dw = REN->read(PAY.buf[index].B_phys_reg);
+         PAY.hot(index).B_value.dw = REN->read(PAY.hot(index).B_phys_reg);
       }
-      if(PAY.buf[index].D_valid)
+      if(PAY.hot(index).D_valid)
       {
-         PAY.buf[index].D_value.dw = REN->read(PAY.buf[index].D_phys_reg);
+         PAY.hot(index).D_value.dw = REN->read(PAY.hot(index).D_phys_reg);
       }
 
 
@@ -78,15 +97,65 @@ void pipeline_t::register_read(unsigned int lane_number) {
       // Advance the instruction to the Execution Stage.
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+      // The first Execute sub-stage is the physical slot at the lane's rotating base (see execute.cc).
+      unsigned int first = Execution_Lanes[lane_number].ex_base;
+
       // There must be space in the Execute Stage because Execution Lanes are free-flowing.
-      assert(!Execution_Lanes[lane_number].ex[0].valid);
+      assert(!REG_VALID(Execution_Lanes[lane_number].ex[first]));
 
       // Copy instruction to Execute Stage.
-      Execution_Lanes[lane_number].ex[0].valid = true;
-      Execution_Lanes[lane_number].ex[0].index = Execution_Lanes[lane_number].rr.index;
-      Execution_Lanes[lane_number].ex[0].branch_mask = Execution_Lanes[lane_number].rr.branch_mask;
+      REG_SET_VALID(Execution_Lanes[lane_number].ex[first]);
+      Execution_Lanes[lane_number].ex[first].index = Execution_Lanes[lane_number].rr.index;
+      Execution_Lanes[lane_number].ex[first].branch_mask = Execution_Lanes[lane_number].rr.branch_mask;
 
       // Remove instruction from Register Read Stage.
       Execution_Lanes[lane_number].rr.valid = false;
    }
 }
+
+
+bool pipeline_t::sources_ready(unsigned int index) {
+   return ((!PAY.hot(index).A_valid || REN->is_ready(PAY.hot(index).A_phys_reg)) &&
+           (!PAY.hot(index).B_valid || REN->is_ready(PAY.hot(index).B_phys_reg)) &&
+           (!PAY.hot(index).D_valid || REN->is_ready(PAY.hot(index).D_phys_reg)));
+}
+
+void pipeline_t::record_spec_consumers(unsigned int index, unsigned int iq_entry) {
+   // Sources that entered the IQ ready only because their producer, a load, woke them up early: if the
+   // load misses, these operands must wait again (see execute()).
+   if (PAY.hot(index).A_valid && REN->is_ready(PAY.hot(index).A_phys_reg) && LHP.speculative(PAY.hot(index).A_phys_reg))
+      LHP.record(PAY.hot(index).A_phys_reg, iq_entry, OPERAND_A);
+   if (PAY.hot(index).B_valid && REN->is_ready(PAY.hot(index).B_phys_reg) && LHP.speculative(PAY.hot(index).B_phys_reg))
+      LHP.record(PAY.hot(index).B_phys_reg, iq_entry, OPERAND_B);
+   if (PAY.hot(index).D_valid && REN->is_ready(PAY.hot(index).D_phys_reg) && LHP.speculative(PAY.hot(index).D_phys_reg))
+      LHP.record(PAY.hot(index).D_phys_reg, iq_entry, OPERAND_D);
+}
+
+void pipeline_t::replay(unsigned int lane_number) {
+   unsigned int index = Execution_Lanes[lane_number].rr.index;
+   uint64_t branch_mask = Execution_Lanes[lane_number].rr.branch_mask;
+   unsigned int iq_entry;
+   bool A_ready, B_ready, D_ready;
+
+   // Re-insert the instruction into the IQ, exactly as the Dispatch Stage does.
+   // There is room: the Dispatch Stage keeps 'issue_width' IQ entries free for replays.
+   A_ready = (!PAY.hot(index).A_valid || REN->is_ready(PAY.hot(index).A_phys_reg));
+   B_ready = (!PAY.hot(index).B_valid || REN->is_ready(PAY.hot(index).B_phys_reg));
+   D_ready = (!PAY.hot(index).D_valid || REN->is_ready(PAY.hot(index).D_phys_reg));
+
+   iq_entry = IQ.dispatch(index, branch_mask, PAY.hot(index).lane_id, PAY.hot(index).A_valid, A_ready, PAY.hot(index).A_phys_reg,
+                          PAY.hot(index).B_valid, B_ready, PAY.hot(index).B_phys_reg, PAY.hot(index).D_valid, D_ready, PAY.hot(index).D_phys_reg);
+
+   if (!A_ready)
+      WL.add(PAY.hot(index).A_phys_reg, iq_entry, OPERAND_A, branch_mask);
+   if (!B_ready)
+      WL.add(PAY.hot(index).B_phys_reg, iq_entry, OPERAND_B, branch_mask);
+   if (!D_ready)
+      WL.add(PAY.hot(index).D_phys_reg, iq_entry, OPERAND_D, branch_mask);
+
+   record_spec_consumers(index, iq_entry);
+   LHP.count_replay();
+
+   // Remove instruction from Register Read Stage.
+   Execution_Lanes[lane_number].rr.valid = false;
+}
@@ -1,4 +1,6 @@
 #include "pipeline.h"
+#include "timeline.h"
+#include "squash_epoch.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -9,6 +11,7 @@
 
 void pipeline_t::rename1() {
    unsigned int i;
+   unsigned int base;
 
    ////////////////////////////////////////////////////////////////////////////////////
    // Try to get the next rename bundle.
@@ -21,7 +24,7 @@ void pipeline_t::rename1() {
    // insertion of the next rename bundle? Check whether or not the pipeline register
    // between rename1 and rename2 still has a rename bundle.
 
-   if (RENAME2[0].valid) {	// The current rename bundle is stalled.
+   if (REG_VALID(RENAME2[0])) {	// The current rename bundle is stalled.
       return;
    }
 
@@ -34,9 +37,12 @@ void pipeline_t::rename1() {
 
    // Get the next rename bundle:
    // The FQ has a rename bundle and there is space for it in the Rename Stage.
+   // The FQ hands over the whole bundle in one operation: it advances its head past the bundle
+   // and returns the bundle's base position. The instructions are read in place from there.
+   base = FQ.pop_bundle(dispatch_width);
    for (i = 0; i < dispatch_width; i++) {
-      RENAME2[i].valid = true;
-      RENAME2[i].index = FQ.pop();
+      REG_SET_VALID(RENAME2[i]);
+      RENAME2[i].index = FQ.at(base, i);
    }
 }
 
@@ -50,8 +56,8 @@ void pipeline_t::rename2() {
    // (2) The Dispatch Stage is stalled.
    // (3) There aren't enough rename resources for the current rename bundle.
 
-   if (!RENAME2[0].valid ||	// First stall condition: There isn't a current rename bundle.
-       DISPATCH[0].valid) {	// Second stall condition: The Dispatch Stage is stalled.
+   if (!REG_VALID(RENAME2[0]) ||	// First stall condition: There isn't a current rename bundle.
+       REG_VALID(DISPATCH[0])) {	// Second stall condition: The Dispatch Stage is stalled.
       return;
    }
    
@@ -59,7 +65,7 @@ void pipeline_t::rename2() {
    unsigned int countof_instr_destreg = 0;
    // Third stall condition: There aren't enough rename resources for the current rename bundle.
    for (i = 0; i < dispatch_width; i++) {
-      assert(RENAME2[i].valid);
+      assert(REG_VALID(RENAME2[i]));
       index = RENAME2[i].index;
 
       // FIX_ME #1
@@ -71,16 +77,16 @@ void pipeline_t::rename2() {
       // Tips:
       // 1. The loop construct, for iterating through all instructions in the rename bundle (0 to dispatch_width),
       //    is already provided for you, above. Note that this comment is within the loop.
-      // 2. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 2. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 3. The instruction's payload has all the information you need to count resource needs.
       //    There is a flag in the instruction's payload that *directly* tells you if this instruction needs a checkpoint.
       //    Another field indicates whether or not the instruction has a destination register.
-      if(PAY.buf[index].checkpoint)
+      if(PAY.hot(index).checkpoint)
       {
          countof_instr_checkpoint++;
       }
 
-      if(PAY.buf[index].C_valid)
+      if(PAY.hot(index).C_valid)
       {
          countof_instr_destreg++;
       }
@@ -97,8 +103,18 @@ void pipeline_t::rename2() {
    // Stalling is achieved by returning from this function ('return').
    // If there are enough resources for the *whole* rename bundle, then do not stall the Rename2 Stage.
    // This is achieved by doing nothing and proceeding to the next statements.
-   if((REN->stall_branch(countof_instr_checkpoint)) || (REN->stall_reg(countof_instr_destreg)))
+   // Shadow renamers observe the same resource check (sizing studies).
+   if (SHADOW.enabled())
+      SHADOW.rename(REN->get_free_regs(), REN->get_GBM(), countof_instr_destreg, countof_instr_checkpoint);
+
+   if(REN->stall_branch(countof_instr_checkpoint))
    {
+      REN->count_stall_branch();
+      return;
+   }
+   if(REN->stall_reg(countof_instr_destreg))
+   {
+      REN->count_stall_reg();
       return;
    }
 
@@ -107,14 +123,16 @@ void pipeline_t::rename2() {
    // Sufficient resources are available to rename the rename bundle.
    //
    for (i = 0; i < dispatch_width; i++) {
-      assert(RENAME2[i].valid);
+      assert(REG_VALID(RENAME2[i]));
       index = RENAME2[i].index;
 
+      TIMELINE.start(index, PAY.cold(index).sequence, PAY.cold(index).pc, cycle);
+
       // FIX_ME #3
       // Rename source registers (first) and destination register (second).
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. The instruction's payload has all the information you need to rename registers, if they exist. In particular:
       //    * whether or not the instruction has a first source register, and its logical register number
       //    * whether or not the instruction has a second source register, and its logical register number
@@ -122,22 +140,22 @@ void pipeline_t::rename2() {
       //    * whether or not the instruction has a destination register, and its logical register number
       // 3. When you rename a logical register to a physical register, remember to *update* the instruction's payload with the physical register specifier,
       //    so that the physical register specifier can be used in subsequent pipeline stages.
-      if(PAY.buf[index].A_valid)
+      if(PAY.hot(index).A_valid)
       {
-         PAY.buf[index].A_phys_reg = REN->rename_rsrc(PAY.buf[index].A_log_reg);
+         PAY.hot(index).A_phys_reg = REN->rename_rsrc(PAY.cold(index).A_log_reg);
       }
-      if(PAY.buf[index].B_valid)
+      if(PAY.hot(index).B_valid)
       {
-         PAY.buf[index].B_phys_reg = REN->rename_rsrc(PAY.buf[index].B_log_reg);
+         PAY.hot(index).B_phys_reg = REN->rename_rsrc(PAY.cold(index).B_log_reg);
       }
-      if(PAY.buf[index].D_valid)
+      if(PAY.hot(index).D_valid)
       {
-         PAY.buf[index].D_phys_reg = REN->rename_rsrc(PAY.buf[index].D_log_reg);
+         PAY.hot(index).D_phys_reg = REN->rename_rsrc(PAY.cold(index).D_log_reg);
       }
       ///dest operand rename////
-      if(PAY.buf[index].C_valid)
+      if(PAY.hot(index).C_valid)
       {
-         PAY.buf[index].C_phys_reg = REN->rename_rdst(PAY.buf[index].C_log_reg);
+         PAY.hot(index).C_phys_reg = REN->rename_rdst(PAY.cold(index).C_log_reg);
       }
 
 
@@ -146,7 +164,7 @@ void pipeline_t::rename2() {
       //
       // Tips:
       // 1. Every instruction gets a branch_mask. An instruction needs to know which branches it depends on, for possible squashing.
-      // 2. The branch_mask is not held in the instruction's PAY.buf[] entry. Rather, it explicitly moves with the instruction
+      // 2. The branch_mask is not held in the instruction's payload entry. Rather, it explicitly moves with the instruction
       //    from one pipeline stage to the next. Normally the branch_mask would be wires at this point in the logic but since we
       //    don't have wires place it temporarily in the RENAME2[] pipeline register alongside the instruction, until it advances
       //    to the DISPATCH[] pipeline register. The required left-hand side of the assignment statement is already provided for you below:
@@ -158,13 +176,13 @@ void pipeline_t::rename2() {
       // If this instruction requires a checkpoint (most branches), then create a checkpoint.
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. There is a flag in the instruction's payload that *directly* tells you if this instruction needs a checkpoint.
       // 3. If you create a checkpoint, remember to *update* the instruction's payload with its branch ID
       //    so that the branch ID can be used in subsequent pipeline stages.
-      if(PAY.buf[index].checkpoint)
+      if(PAY.hot(index).checkpoint)
       {
-         PAY.buf[index].branch_ID = REN->checkpoint();
+         PAY.hot(index).branch_ID = REN->checkpoint();
       }
 
 
@@ -174,9 +192,9 @@ void pipeline_t::rename2() {
    // Transfer the rename bundle from the Rename Stage to the Dispatch Stage.
    //
    for (i = 0; i < dispatch_width; i++) {
-      assert(RENAME2[i].valid && !DISPATCH[i].valid);
+      assert(REG_VALID(RENAME2[i]) && !REG_VALID(DISPATCH[i]));
       RENAME2[i].valid = false;
-      DISPATCH[i].valid = true;
+      REG_SET_VALID(DISPATCH[i]);
       DISPATCH[i].index = RENAME2[i].index;
       DISPATCH[i].branch_mask = RENAME2[i].branch_mask;
    }
@@ -1,6 +1,7 @@
 #include "renamer.h"
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 #include <iostream>
 #include <math.h>
 #include <bits/stdc++.h> 
@@ -21,6 +22,33 @@ renamer::renamer(uint64_t n_log_regs,
     RMT = new uint64_t[logical_reg];
     AMT = new uint64_t[logical_reg];
 
+    allocate_sized();
+
+    /////////initialise checkpoints///////////////////
+    ///not needed, going to write to it before read
+
+    reset_empty();
+
+    for(uint64_t j = 0; j < physical_reg; j++)
+    {
+        phy_reg_file[j] = j;
+    }
+
+    stall_reg_count = 0;
+    stall_branch_count = 0;
+    stall_dispatch_count = 0;
+}
+
+renamer::~renamer()
+{
+    delete[] RMT;
+    delete[] AMT;
+    free_sized();
+};
+
+//////Structures sized by the number of physical registers or branches////////
+void renamer::allocate_sized()
+{
     //////allocate space for free list, active list, physical register file and its ready bits
     free_list.flist = new uint64_t[physical_reg - logical_reg];
     active_list.alist = new AList[physical_reg - logical_reg];
@@ -35,10 +63,54 @@ renamer::renamer(uint64_t n_log_regs,
         //checkpoints[i].checkpointed_GBM = 0;
         //checkpoints[i].checkpointed_head_flist = 0;
 	}
+}
 
-    /////////initialise checkpoints///////////////////
-    ///not needed, going to write to it before read
+void renamer::free_sized()
+{
+    delete[] phy_reg_file;
+    delete[] phy_reg_file_rdy_bit;
+    for(uint64_t i=0; i<num_branch_unreslvd; i++)
+	{
+		delete[] checkpoints[i].checkpointed_RMT;
+	}
+    delete[] checkpoints;
+    delete[] free_list.flist;
+    delete[] active_list.alist;
+}
 
+void renamer::reconfigure(uint64_t n_phys_regs, uint64_t n_branches)
+{
+    assert(n_phys_regs > logical_reg);
+    assert((1 <= n_branches) && (n_branches <= 64));
+    ////only an empty pipeline can be reconfigured////
+    assert((active_list.ALsize == 0) && (GBM == 0));
+
+    ////keep the committed value of each logical register////
+    uint64_t *arch_values = new uint64_t[logical_reg];
+    for(uint64_t i = 0; i < logical_reg; i++)
+    {
+        arch_values[i] = phy_reg_file[AMT[i]];
+    }
+
+    free_sized();
+    physical_reg = n_phys_regs;
+    num_branch_unreslvd = n_branches;
+    allocate_sized();
+
+    load_arch_state(arch_values, logical_reg);
+    delete[] arch_values;
+}
+
+void renamer::copy_AMT_to_RMT()
+	{
+		for(uint64_t i=0; i< logical_reg; i++)
+		{
+			RMT[i] = AMT[i];
+		}
+	}   
+//////Empty pipeline: identity maps, all other registers free////////
+void renamer::reset_empty()
+{
     /////////initialise active list and free list/////////
     //head=tail=0
     free_list.head_flist = 0;
@@ -73,7 +145,7 @@ renamer::renamer(uint64_t n_log_regs,
     ///////////////////initialise GBM//////////////////////////////
     GBM = 0;
 
-    ///////////initialise RMT, AMT, PRF, PRF ready bits////////////
+    ///////////initialise RMT, AMT, PRF ready bits////////////
     for(uint64_t i=0; i < logical_reg; i++)
     {
         RMT[i] = i;
@@ -82,33 +154,114 @@ renamer::renamer(uint64_t n_log_regs,
 
     for(uint64_t j = 0; j < physical_reg; j++)
     {
-        phy_reg_file[j] = j;
         phy_reg_file_rdy_bit[j] = 1;
     }
 }
 
-renamer::~renamer()
+void renamer::load_arch_state(const uint64_t *arch_values, uint64_t n)
 {
-    delete[] RMT;
-    delete[] AMT;
-    delete[] phy_reg_file;
-    delete[] phy_reg_file_rdy_bit;
-    for(uint64_t i=0; i<num_branch_unreslvd; i++)
-	{
-		delete[] checkpoints[i].checkpointed_RMT;
-	}
-    delete[] checkpoints;
-    delete[] free_list.flist;
-    delete[] active_list.alist;
-};
+    assert(n == logical_reg);
+    reset_empty();
+
+    /////////PRF[i] holds logical register i (RMT[i] == AMT[i] == i)/////////
+    for(uint64_t i = 0; i < logical_reg; i++)
+    {
+        phy_reg_file[i] = arch_values[i];
+    }
+}
+
+//////////////////Pipeline checkpoint files//////////////////////
+uint64_t renamer::state_size()
+{
+    uint64_t AL_FL_size = physical_reg - logical_reg;
+    return (sizeof(SavedState) +
+            2 * logical_reg * sizeof(uint64_t) +                    //RMT, AMT
+            AL_FL_size * sizeof(uint64_t) +                         //free list
+            AL_FL_size * sizeof(AList) +                            //active list
+            physical_reg * (sizeof(uint64_t) + sizeof(bool)) +      //PRF, ready bits
+            num_branch_unreslvd * (logical_reg + 2) * sizeof(uint64_t));   //checkpoints
+}
+
+void renamer::save_state(void *buf)
+{
+    uint64_t AL_FL_size = physical_reg - logical_reg;
+    char *p = (char *)buf;
+
+    SavedState hdr;
+    hdr.logical_reg = logical_reg;
+    hdr.physical_reg = physical_reg;
+    hdr.num_branch_unreslvd = num_branch_unreslvd;
+    hdr.head_flist = free_list.head_flist;
+    hdr.tail_flist = free_list.tail_flist;
+    hdr.FLsize = free_list.FLsize;
+    hdr.head_alist = active_list.head_alist;
+    hdr.tail_alist = active_list.tail_alist;
+    hdr.ALsize = active_list.ALsize;
+    hdr.GBM = GBM;
+    memcpy(p, &hdr, sizeof(hdr));                                   p += sizeof(hdr);
+
+    memcpy(p, RMT, logical_reg * sizeof(uint64_t));                 p += logical_reg * sizeof(uint64_t);
+    memcpy(p, AMT, logical_reg * sizeof(uint64_t));                 p += logical_reg * sizeof(uint64_t);
+    memcpy(p, free_list.flist, AL_FL_size * sizeof(uint64_t));      p += AL_FL_size * sizeof(uint64_t);
+    memcpy(p, active_list.alist, AL_FL_size * sizeof(AList));       p += AL_FL_size * sizeof(AList);
+    memcpy(p, phy_reg_file, physical_reg * sizeof(uint64_t));       p += physical_reg * sizeof(uint64_t);
+    memcpy(p, phy_reg_file_rdy_bit, physical_reg * sizeof(bool));   p += physical_reg * sizeof(bool);
+
+    for(uint64_t i = 0; i < num_branch_unreslvd; i++)
+    {
+        memcpy(p, checkpoints[i].checkpointed_RMT, logical_reg * sizeof(uint64_t));  p += logical_reg * sizeof(uint64_t);
+        memcpy(p, &checkpoints[i].checkpointed_head_flist, sizeof(uint64_t));        p += sizeof(uint64_t);
+        memcpy(p, &checkpoints[i].checkpointed_GBM, sizeof(uint64_t));               p += sizeof(uint64_t);
+    }
+
+    assert((uint64_t)(p - (char *)buf) == state_size());
+}
+
+bool renamer::check_state(const void *buf, uint64_t size)
+{
+    SavedState hdr;
+    if ((buf == NULL) || (size != state_size()))
+        return false;
+    memcpy(&hdr, buf, sizeof(hdr));
+    return ((hdr.logical_reg == logical_reg) &&
+            (hdr.physical_reg == physical_reg) &&
+            (hdr.num_branch_unreslvd == num_branch_unreslvd));
+}
+
+bool renamer::restore_state(const void *buf, uint64_t size)
+{
+    uint64_t AL_FL_size = physical_reg - logical_reg;
+    const char *p = (const char *)buf;
+
+    SavedState hdr;
+    if (!check_state(buf, size))
+        return false;
+    memcpy(&hdr, p, sizeof(hdr));                                   p += sizeof(hdr);
+
+    free_list.head_flist = hdr.head_flist;
+    free_list.tail_flist = hdr.tail_flist;
+    free_list.FLsize = hdr.FLsize;
+    active_list.head_alist = hdr.head_alist;
+    active_list.tail_alist = hdr.tail_alist;
+    active_list.ALsize = hdr.ALsize;
+    GBM = hdr.GBM;
+
+    memcpy(RMT, p, logical_reg * sizeof(uint64_t));                 p += logical_reg * sizeof(uint64_t);
+    memcpy(AMT, p, logical_reg * sizeof(uint64_t));                 p += logical_reg * sizeof(uint64_t);
+    memcpy(free_list.flist, p, AL_FL_size * sizeof(uint64_t));      p += AL_FL_size * sizeof(uint64_t);
+    memcpy(active_list.alist, p, AL_FL_size * sizeof(AList));       p += AL_FL_size * sizeof(AList);
+    memcpy(phy_reg_file, p, physical_reg * sizeof(uint64_t));       p += physical_reg * sizeof(uint64_t);
+    memcpy(phy_reg_file_rdy_bit, p, physical_reg * sizeof(bool));   p += physical_reg * sizeof(bool);
+
+    for(uint64_t i = 0; i < num_branch_unreslvd; i++)
+    {
+        memcpy(checkpoints[i].checkpointed_RMT, p, logical_reg * sizeof(uint64_t));  p += logical_reg * sizeof(uint64_t);
+        memcpy(&checkpoints[i].checkpointed_head_flist, p, sizeof(uint64_t));        p += sizeof(uint64_t);
+        memcpy(&checkpoints[i].checkpointed_GBM, p, sizeof(uint64_t));               p += sizeof(uint64_t);
+    }
+    return true;
+}
 
-void renamer::copy_AMT_to_RMT()
-	{
-		for(uint64_t i=0; i< logical_reg; i++)
-		{
-			RMT[i] = AMT[i];
-		}
-	}   
 ///////////////////Rename Stage Functions///////////////////////
 bool renamer::stall_reg(uint64_t bundle_dst)
 {
@@ -353,6 +506,15 @@ void renamer::resolve(uint64_t AL_index,
                 }
              }
 
+void renamer::resolve_mask(uint64_t resolved_mask)
+{
+    GBM = GBM & ~resolved_mask;
+    for (uint64_t i=0; i<num_branch_unreslvd; i++)
+    {
+        checkpoints[i].checkpointed_GBM = checkpoints[i].checkpointed_GBM & ~resolved_mask;
+    }
+}
+
 ///////////Retire Stage Functions//////////////////////
 bool renamer::precommit(bool &completed,
                        bool &exception, bool &load_viol, bool &br_misp, bool &val_misp,
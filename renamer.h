@@ -61,9 +61,10 @@ private:
 	//      available for deferred-recovery Approaches #1 or #2.
 	//      Project 1 uses Approach #5, however.
 	// 8. value misprediction bit
-	//    * At present, not ever set by the pipeline. It is simply
-	//      available for deferred-recovery Approaches #1 or #2,
-	//      if value prediction is added (e.g., research projects).
+	//    * Set by the pipeline when value prediction (VALUE_PRED)
+	//      mispredicts the instruction's result. Recovery uses
+	//      deferred-recovery Approach #1 (squash after the instruction
+	//      when it retires).
 	// ----- Fields indicating special instruction types.
 	// 9. load flag (indicates whether or not the instr. is a load)
 	// 10. store flag (indicates whether or not the instr. is a store)
@@ -162,10 +163,38 @@ private:
 	};
 	struct BranchCheckpoints *checkpoints;
 	/////////////////////////////////////////////////////////////////////
+	// Stall counters: number of cycles in which the Rename2 Stage
+	// stalled on checkpoints or physical registers, and the Dispatch
+	// Stage stalled on the Active List. The stages count their stalls
+	// (count_stall_*()): the stall_*() functions are also used as
+	// plain queries.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t stall_reg_count;
+	uint64_t stall_branch_count;
+	uint64_t stall_dispatch_count;
+	/////////////////////////////////////////////////////////////////////
 	// Private functions.
 	// e.g., a generic function to copy state from one map to another.
 	/////////////////////////////////////////////////////////////////////
 	void copy_AMT_to_RMT();
+	void reset_empty();
+	void allocate_sized();
+	void free_sized();
+
+	/////////////////////////////////////////////////////////////////////
+	// Fixed part of a saved renamer state (see save_state()).
+	// The geometry is saved so that a state is only restored into a
+	// renamer of the same size.
+	/////////////////////////////////////////////////////////////////////
+	struct SavedState
+	{
+		uint64_t logical_reg;
+		uint64_t physical_reg;
+		uint64_t num_branch_unreslvd;
+		uint64_t head_flist, tail_flist, FLsize;
+		uint64_t head_alist, tail_alist, ALsize;
+		uint64_t GBM;
+	};
 
 public:
     // void AMT_to_RMT() {copy_AMT_to_RMT();}
@@ -201,6 +230,75 @@ public:
 	/////////////////////////////////////////////////////////////////////
 	~renamer();
 
+	/////////////////////////////////////////////////////////////////////
+	// Fast-forward support: start the renamer from architectural state
+	// produced by the functional simulator.
+	//
+	// Inputs:
+	// 1. arch_values: values of logical registers 0 .. n_log_regs-1.
+	// 2. n: number of values in arch_values; must equal n_log_regs.
+	//
+	// The renamer is reset to an empty pipeline, exactly as after
+	// construction: RMT and AMT map logical register i to physical
+	// register i, and the free list holds the remaining physical
+	// registers. Physical register i is then loaded with arch_values[i]
+	// and marked ready.
+	/////////////////////////////////////////////////////////////////////
+	void load_arch_state(const uint64_t *arch_values, uint64_t n);
+
+	/////////////////////////////////////////////////////////////////////
+	// Re-parameterize the renamer after construction (e.g., in a
+	// what-if child process).
+	//
+	// Inputs:
+	// 1. n_phys_regs: the new number of physical registers.
+	// 2. n_branches: the new maximum number of unresolved branches.
+	//
+	// The renamer must be empty (call squash() first). The committed
+	// value of every logical register is kept; the renamer restarts as
+	// in load_arch_state().
+	/////////////////////////////////////////////////////////////////////
+	void reconfigure(uint64_t n_phys_regs, uint64_t n_branches);
+	uint64_t get_n_phys_regs() {return physical_reg;}
+	uint64_t get_n_branches() {return num_branch_unreslvd;}
+
+	/////////////////////////////////////////////////////////////////////
+	// Occupancy of the renamer's resources (e.g., for shadow renamers):
+	// free physical registers, Active List entries in use, and the GBM
+	// (one '1' bit per checkpoint in use).
+	/////////////////////////////////////////////////////////////////////
+	uint64_t get_free_regs() {return free_list.FLsize;}
+	uint64_t get_active_size() {return active_list.ALsize;}
+	uint64_t get_GBM() {return GBM;}
+
+	/////////////////////////////////////////////////////////////////////
+	// Stall counters: a stage that stalls on the result of stall_reg(),
+	// stall_branch() or stall_dispatch() counts it, once per cycle.
+	/////////////////////////////////////////////////////////////////////
+	void count_stall_reg() {stall_reg_count++;}
+	void count_stall_branch() {stall_branch_count++;}
+	void count_stall_dispatch(uint64_t cycles = 1) {stall_dispatch_count += cycles;}
+	uint64_t get_stall_reg_count() {return stall_reg_count;}
+	uint64_t get_stall_branch_count() {return stall_branch_count;}
+	uint64_t get_stall_dispatch_count() {return stall_dispatch_count;}
+
+	/////////////////////////////////////////////////////////////////////
+	// Pipeline checkpoint files.
+	//
+	// state_size(): number of bytes of a saved renamer state.
+	// save_state(): copy the complete renamer state (RMT, AMT, free list,
+	//    active list, PRF, ready bits, GBM, branch checkpoints) into 'buf',
+	//    as a header followed by the raw arrays.
+	// check_state(): return 'true' if 'buf' holds a state saved by a
+	//    renamer of the same size, without changing anything.
+	// restore_state(): the reverse of save_state(). Returns 'false' (and
+	//    leaves the renamer unchanged) if check_state() fails.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t state_size();
+	void save_state(void *buf);
+	bool check_state(const void *buf, uint64_t size);
+	bool restore_state(const void *buf, uint64_t size);
+
    // void copy_AMT_to_RMT();
 	//////////////////////////////////////////
 	// Functions related to Rename Stage.   //
@@ -436,6 +534,18 @@ public:
 		     uint64_t branch_ID,
 		     bool correct);
 
+	/////////////////////////////////////////////////////////////////////
+	// Batched form of resolve() for correctly-predicted branches.
+	//
+	// Inputs:
+	// 1. resolved_mask: one '1' bit per branch ID that resolved
+	//    correctly (e.g., all correct resolutions of one cycle).
+	//
+	// Clears all of these bits in the GBM and in all checkpointed GBMs
+	// in a single sweep, freeing their checkpoints.
+	/////////////////////////////////////////////////////////////////////
+	void resolve_mask(uint64_t resolved_mask);
+
 	//////////////////////////////////////////
 	// Functions related to Retire Stage.   //
 	//////////////////////////////////////////
@@ -1,15 +1,30 @@
 #include "pipeline.h"
 #include "trap.h"
 #include "mmu.h"
+#include "timeline.h"
 
 
 void pipeline_t::retire(size_t& instret) {
    bool head_valid;
    bool completed, exception, load_viol, br_misp, val_misp, load, store, branch, amo, csr;
    reg_t offending_PC;
+   unsigned int n;
+   bool window_end;	// sampled simulation: end of the detailed window
 
    bool amo_success;
-   trap_t *trap = NULL; // Supress uninitialized warning.
+
+   // Convergence-based early termination: feed the windowed statistics to the monitor once per cycle.
+   // The simulator ends the run once CONVERGE.converged().
+   if (CONVERGE.enabled()) {
+      conv_counts_t counts;
+      counts.num_insn = num_insn;
+      counts.commit_count = commit_count;
+      counts.recovery_count = recovery_count;
+      counts.stall_reg = REN->get_stall_reg_count();
+      counts.stall_branch = REN->get_stall_branch_count();
+      counts.stall_dispatch = REN->get_stall_dispatch_count();
+      CONVERGE.tick(cycle, counts);
+   }
 
 
    // FIX_ME #17a
@@ -29,7 +44,7 @@ void pipeline_t::retire(size_t& instret) {
    //    variable 'head_valid'.
    // 3. Study the code that follows the code that you added, and simply note the following observations:
    //    * The retire stage only does something if the renamer module's precommit() function signals
-   //      a non-empty active list and that the head instruction is complete: "if (head_valid && completed)".
+   //      a non-empty active list and that the head instruction is complete: "if (!head_valid || !completed) break;".
    //    * If the completed head instruction is not an exception -- "if (!exception)" -- some
    //      additional processing is needed for loads and stores (LSU.commit()), atomic memory operations
    //      (execute_amo()), and system instructions (execute_csr()).  Note that a store, amo, or csr instruction
@@ -46,14 +61,23 @@ void pipeline_t::retire(size_t& instret) {
    //      "else if (!exception && load_viol)" -- all instructions including the load instruction are squashed.
    //    * Alternatively, if the completed head instruction is an exception, the trap is taken and the pipeline
    //      is squashed including the offending instruction.
-   head_valid = REN->precommit(completed, exception, load_viol, br_misp, val_misp, load, store, branch, amo, csr, offending_PC);
-
-
-   if (head_valid && completed) {    // AL head exists and completed
+   //
+   // Retire up to 'retire_width' instructions from the head of the Active List in one pass.
+   // The pass stops at the first head that is not completed, and after the first instruction that
+   // squashes the pipeline: an exception, a load violation, an AMO, a CSR, or a branch/value
+   // misprediction with "approach #1 recovery".
+   // The LSU, branch predictor and payload buffer are still updated once per instruction
+   // (LSU.commit(), BP.verify_pred(), PAY.pop()): their interfaces take one entry at a time.
+   for (n = 0; n < retire_width; n++) {
+      head_valid = REN->precommit(completed, exception, load_viol, br_misp, val_misp, load, store, branch, amo, csr, offending_PC);
+      window_end = false;
+
+      if (!head_valid || !completed)    // AL empty, or AL head not completed
+         break;
 
       // Sanity checks of the 'amo' and 'csr' flags.
-      assert(!amo || IS_AMO(PAY.buf[PAY.head].flags));
-      assert(!csr || IS_CSR(PAY.buf[PAY.head].flags));
+      assert(!amo || IS_AMO(PAY.hot(PAY.head).flags));
+      assert(!csr || IS_CSR(PAY.hot(PAY.head).flags));
 
       // If no exception (yet):
       // 1. If the instruction is a load or store, signal the LSU to commit the load or store.
@@ -70,14 +94,14 @@ void pipeline_t::retire(size_t& instret) {
                assert(amo_success);  // Assert store-conditionals (SC) are successful.
          }
          else if (amo) {
-            exception = execute_amo();
+            exception = (execute_amo() != TRAP_NONE);
          }
          else if (csr) {
-            exception = execute_csr();
+            exception = (execute_csr() != TRAP_NONE);
          }
 
          if (exception)
-	    REN->set_exception(PAY.buf[PAY.head].AL_index);
+	    REN->set_exception(PAY.hot(PAY.head).AL_index);
       }
 
       if (!exception && !load_viol) {
@@ -90,40 +114,40 @@ void pipeline_t::retire(size_t& instret) {
          // If the committed instruction is a branch, signal the branch predictor to commit its oldest branch.
          if (branch && !PERFECT_BRANCH_PRED) {
 	    // TODO (ER): Change the branch predictor interface as follows: BP.commit().
-            BP.verify_pred(PAY.buf[PAY.head].pred_tag, PAY.buf[PAY.head].c_next_pc, false);
+            BP.verify_pred(PAY.cold(PAY.head).pred_tag, PAY.cold(PAY.head).c_next_pc, false);
          }
 
          // If FP op, cheat and copy the fflags from the functional simulator.
          // TODO: fflags should be (and can be) generated by the ALU. This was done to expedite porting of 721sim to RISCV from PISA.
-         if (IS_FP_OP(PAY.buf[PAY.head].flags)) {
-	    db_t *actual = pipe->peek(PAY.buf[PAY.head].db_index);	// Pointer to corresponding instruction in the functional simulator.
+         if (IS_FP_OP(PAY.hot(PAY.head).flags)) {
+	    db_t *actual = pipe->peek(PAY.cold(PAY.head).db_index);	// Pointer to corresponding instruction in the functional simulator.
             get_state()->fflags = actual->a_state->fflags;
          }
 
 	 // Check results.
-	 checker();
+	 check_retired(false, retired_next_pc(PAY.head));
+	 TIMELINE.retire(PAY.head, cycle);
 
 	 // Keep track of the number of retired instructions.
 	 num_insn++;
          instret++;
 	 inc_counter(commit_count);
-	 if (PAY.buf[PAY.head].split && PAY.buf[PAY.head].upper)
+	 if (PAY.hot(PAY.head).split && PAY.hot(PAY.head).upper)
             num_insn_split++;
 
+	 // Sampled simulation: check whether this instruction ends the detailed window.
+	 // A split instruction counts once, when its second half retires: a window never ends
+	 // between the two halves.
+	 if (!PAY.hot(PAY.head).split || !PAY.hot(PAY.head).upper)
+	    window_end = SAMPLER.retire(cycle);
+
 	 // Cases of complete pipeline squash after the head instruction.
 	 // 1. Atomic memory operation.
 	 // 2. System instruction.
 	 // 3. Mispredicted branch for which "approach #1 recovery" is configured.
 	 // 4. Value-mispredicted instruction for which "approach #1 recovery" is configured.
          if (amo || csr || br_misp || val_misp) {
-            insn_t inst = PAY.buf[PAY.head].inst;
-	    reg_t next_inst_pc;
-            if ((inst.funct3() == FN3_SC_SB) && (inst.funct12() == FN12_SRET))  // SRET instruction.
-               next_inst_pc = state.epc;
-	    else if (br_misp)
-               next_inst_pc = PAY.buf[PAY.head].c_next_pc;
-	    else
-	       next_inst_pc = INCREMENT_PC(PAY.buf[PAY.head].pc);
+	    reg_t next_inst_pc = retired_next_pc(PAY.head);
 
             // The head instruction was already committed above (fix #17b).
 	    // Squash all instructions after it.
@@ -131,7 +155,20 @@ void pipeline_t::retire(size_t& instret) {
             inc_counter(recovery_count);
 
 	    // Pop the instruction from PAY.
-	    if (!PAY.buf[PAY.head].split) PAY.pop();
+	    if (!PAY.hot(PAY.head).split) PAY.pop();
+	    PAY.pop();
+
+            // Flush PAY.
+            PAY.clear();
+         }
+         else if (window_end) {
+            // End of a detailed sampling window. Drain the pipeline: squash all instructions after
+            // the head instruction, so that the committed state is in the AMT. The simulator then
+            // switches to functional simulation (SAMPLER.detailed() is false).
+            squash_complete(retired_next_pc(PAY.head));
+
+	    // Pop the instruction from PAY.
+	    if (!PAY.hot(PAY.head).split) PAY.pop();
 	    PAY.pop();
 
             // Flush PAY.
@@ -139,7 +176,7 @@ void pipeline_t::retire(size_t& instret) {
          }
          else {
 	    // Pop the instruction from PAY.
-	    if (!PAY.buf[PAY.head].split) PAY.pop();
+	    if (!PAY.hot(PAY.head).split) PAY.pop();
 	    PAY.pop();
          }
       }
@@ -148,14 +185,14 @@ void pipeline_t::retire(size_t& instret) {
 	 // Therefore the load is incorrect and not committed.
          assert(load);
 
-         // If the simple sticky-bit memory dependence predictor is enabled,
+         // If the memory dependence predictor is enabled,
          // add the offending load to the predictor.
 	 if (MEM_DEP_PRED) {
-	    //assert(MDP.find(PAY.buf[PAY.head].pc) == MDP.end());
-	    MDP[PAY.buf[PAY.head].pc] = true;
+	    MDP.train(PAY.cold(PAY.head).pc);
 	 }
 
          // Full squash, including the mispredicted load, and restart fetching from the load.
+         TIMELINE.squash(PAY.head, cycle);
          squash_complete(offending_PC);
          inc_counter(recovery_count);
 
@@ -163,19 +200,17 @@ void pipeline_t::retire(size_t& instret) {
          PAY.clear();
       }
       else {   // exception
-         trap = PAY.buf[PAY.head].trap;
-
          // CSR exceptions are micro-architectural exceptions and are
          // not defined by the ISA. These must be handled exclusively by
          // the micro-arch and is different from other exceptions specified
          // in the ISA.
          // This is a serialize trap - Refetch the CSR instruction
          reg_t jump_PC;
-         if (trap->cause() == CAUSE_CSR_INSTRUCTION) {
+         if (PAY.cold(PAY.head).trap.cause == CAUSE_CSR_INSTRUCTION) {
             jump_PC = offending_PC;
          } 
          else {
-            jump_PC = take_trap(*trap, offending_PC);
+            jump_PC = take_trap_record(PAY.cold(PAY.head).trap, offending_PC);
          }
 
          // Keep track of the number of retired instructions.
@@ -185,7 +220,14 @@ void pipeline_t::retire(size_t& instret) {
          inc_counter(exception_count);
 
          // Compare pipeline simulator against functional simulator.
-         checker();
+         check_retired(true, jump_PC);
+         TIMELINE.retire(PAY.head, cycle);
+
+         // Sampled simulation: the excepting instruction counts like any other retirement, except
+         // a serializing CSR instruction, which retires again when it is refetched.
+         // The squash below also drains the pipeline if it ends the detailed window.
+         if (PAY.cold(PAY.head).trap.cause != CAUSE_CSR_INSTRUCTION)
+            window_end = SAMPLER.retire(cycle);
 
          // Squash the pipeline.
          squash_complete(jump_PC);
@@ -194,103 +236,164 @@ void pipeline_t::retire(size_t& instret) {
          // Flush PAY.
          PAY.clear();
       }
+
+      // Instructions that squash the pipeline end the retire pass.
+      if (exception || load_viol || amo || csr || br_misp || val_misp || window_end)
+         break;
    }
 }
 
 
-bool pipeline_t::execute_amo() {
+reg_t pipeline_t::retired_next_pc(unsigned int index) {
+   insn_t inst = PAY.cold(index).inst;
+
+   // The pc of the instruction that follows the retiring instruction (no exception).
+   if (IS_CSR(PAY.hot(index).flags) && (inst.funct3() == FN3_SC_SB) && (inst.funct12() == FN12_SRET))  // SRET instruction.
+      return(state.epc);
+   else if (IS_BRANCH(PAY.hot(index).flags))
+      return(PAY.cold(index).c_next_pc);
+   else
+      return(INCREMENT_PC(PAY.cold(index).pc));
+}
+
+
+void pipeline_t::check_retired(bool exception, reg_t next_pc) {
+   unsigned int index = PAY.head;
+   commit_record_t rec;
+
+   // Compare the head instruction against the functional simulator, according to the checker mode:
+   // * CHECK_SYNC:    every instruction, here.
+   // * CHECK_SAMPLED: every Nth instruction, here.
+   // * CHECK_ASYNC:   every Nth instruction, off the critical path: the record is pushed into
+   //                  a ring that the checker thread drains. push() captures the functional
+   //                  simulator's expected values now, while its debug buffer entry is valid.
+   // 'next_pc' is where the pipeline continues after the instruction (or the trap).
+   if (!CHECKER.sample())
+      return;
+
+   if (CHECKER.get_mode() != CHECK_ASYNC) {
+      checker();
+      return;
+   }
+
+   rec.sequence = PAY.cold(index).sequence;
+   rec.pc = PAY.cold(index).pc;
+   rec.next_pc = next_pc;
+   rec.db_index = PAY.cold(index).db_index;
+   rec.cycle = cycle;
+   rec.exception = exception;
+   rec.C_valid = PAY.hot(index).C_valid;
+   rec.C_log_reg = PAY.cold(index).C_log_reg;
+   rec.C_value = PAY.hot(index).C_value.dw;
+   CHECKER.push(rec);
+
+   // Stop at the first divergence reported by the checker thread.
+   if (CHECKER.diverged()) {
+      CHECKER.report(stderr);
+      fflush(0);
+      assert(0);
+   }
+}
+
+
+uint64_t pipeline_t::execute_amo() {
    unsigned int index = PAY.head;
-   insn_t inst = PAY.buf[index].inst;
+   insn_t inst = PAY.cold(index).inst;
    reg_t read_amo_value = 0xdeadbeef;
-   bool exception = false;
+   uint64_t cause = TRAP_NONE;
+
+   // Execute the atomic memory operation at the head of the Active List.
+   // Returns the cause of its fault, or TRAP_NONE.
 
    try {
       if (inst.funct3() == FN3_AMO_W) {
-         read_amo_value = mmu->load_int32(PAY.buf[index].A_value.dw);
+         read_amo_value = mmu->load_int32(PAY.hot(index).A_value.dw);
          uint32_t write_amo_value;
          switch (inst.funct5()) {
             case FN5_AMO_SWAP:
-               write_amo_value = PAY.buf[index].B_value.dw;
+               write_amo_value = PAY.hot(index).B_value.dw;
                break;
             case FN5_AMO_ADD:
-               write_amo_value = PAY.buf[index].B_value.dw + read_amo_value;
+               write_amo_value = PAY.hot(index).B_value.dw + read_amo_value;
                break;
             case FN5_AMO_XOR:
-               write_amo_value = PAY.buf[index].B_value.dw ^ read_amo_value;
+               write_amo_value = PAY.hot(index).B_value.dw ^ read_amo_value;
                break;
             case FN5_AMO_AND:
-               write_amo_value = PAY.buf[index].B_value.dw & read_amo_value;
+               write_amo_value = PAY.hot(index).B_value.dw & read_amo_value;
                break;
             case FN5_AMO_OR:
-               write_amo_value = PAY.buf[index].B_value.dw | read_amo_value;
+               write_amo_value = PAY.hot(index).B_value.dw | read_amo_value;
                break;
             case FN5_AMO_MIN:
-               write_amo_value = std::min(int32_t(PAY.buf[index].B_value.dw), int32_t(read_amo_value));
+               write_amo_value = std::min(int32_t(PAY.hot(index).B_value.dw), int32_t(read_amo_value));
                break;
             case FN5_AMO_MAX:
-               write_amo_value = std::max(int32_t(PAY.buf[index].B_value.dw), int32_t(read_amo_value));
+               write_amo_value = std::max(int32_t(PAY.hot(index).B_value.dw), int32_t(read_amo_value));
                break;
             case FN5_AMO_MINU:
-               write_amo_value = std::min(uint32_t(PAY.buf[index].B_value.dw), uint32_t(read_amo_value));
+               write_amo_value = std::min(uint32_t(PAY.hot(index).B_value.dw), uint32_t(read_amo_value));
                break;
             case FN5_AMO_MAXU:
-               write_amo_value = std::max(uint32_t(PAY.buf[index].B_value.dw), uint32_t(read_amo_value));
+               write_amo_value = std::max(uint32_t(PAY.hot(index).B_value.dw), uint32_t(read_amo_value));
                break;
             default:
                assert(0);
                break;
          }
-         mmu->store_uint32(PAY.buf[index].A_value.dw, write_amo_value);
+         mmu->store_uint32(PAY.hot(index).A_value.dw, write_amo_value);
       }
       else if (inst.funct3() == FN3_AMO_D) {
-         read_amo_value = mmu->load_int64(PAY.buf[index].A_value.dw);
+         read_amo_value = mmu->load_int64(PAY.hot(index).A_value.dw);
          reg_t write_amo_value;
          switch (inst.funct5()) {
             case FN5_AMO_SWAP:
-               write_amo_value = PAY.buf[index].B_value.dw;
+               write_amo_value = PAY.hot(index).B_value.dw;
                break;
             case FN5_AMO_ADD:
-               write_amo_value = PAY.buf[index].B_value.dw + read_amo_value;
+               write_amo_value = PAY.hot(index).B_value.dw + read_amo_value;
                break;
             case FN5_AMO_XOR:
-               write_amo_value = PAY.buf[index].B_value.dw ^ read_amo_value;
+               write_amo_value = PAY.hot(index).B_value.dw ^ read_amo_value;
                break;
             case FN5_AMO_AND:
-               write_amo_value = PAY.buf[index].B_value.dw & read_amo_value;
+               write_amo_value = PAY.hot(index).B_value.dw & read_amo_value;
                break;
             case FN5_AMO_OR:
-               write_amo_value = PAY.buf[index].B_value.dw | read_amo_value;
+               write_amo_value = PAY.hot(index).B_value.dw | read_amo_value;
                break;
             case FN5_AMO_MIN:
-               write_amo_value = std::min(int64_t(PAY.buf[index].B_value.dw), int64_t(read_amo_value));
+               write_amo_value = std::min(int64_t(PAY.hot(index).B_value.dw), int64_t(read_amo_value));
                break;
             case FN5_AMO_MAX:
-               write_amo_value = std::max(int64_t(PAY.buf[index].B_value.dw), int64_t(read_amo_value));
+               write_amo_value = std::max(int64_t(PAY.hot(index).B_value.dw), int64_t(read_amo_value));
                break;
             case FN5_AMO_MINU:
-               write_amo_value = std::min(PAY.buf[index].B_value.dw, read_amo_value);
+               write_amo_value = std::min(PAY.hot(index).B_value.dw, read_amo_value);
                break;
             case FN5_AMO_MAXU:
-               write_amo_value = std::max(PAY.buf[index].B_value.dw, read_amo_value);
+               write_amo_value = std::max(PAY.hot(index).B_value.dw, read_amo_value);
                break;
             default:
                assert(0);
                break;
          }
-         mmu->store_uint64(PAY.buf[index].A_value.dw, write_amo_value);
+         mmu->store_uint64(PAY.hot(index).A_value.dw, write_amo_value);
       }
       else {
          assert(0);
       }
    }
+   // The load half of the AMO goes first, so a misaligned or inaccessible
+   // address faults as a load, the same as in the functional model.
    catch (mem_trap_t& t) {
-      exception = true;
+      cause = t.cause();
       switch (t.cause()) {
+         case CAUSE_FAULT_LOAD:
+         case CAUSE_MISALIGNED_LOAD:
          case CAUSE_FAULT_STORE:
-            PAY.buf[index].trap = new trap_store_access_fault(t.get_badvaddr());
-            break;
          case CAUSE_MISALIGNED_STORE:
-            PAY.buf[index].trap = new trap_store_address_misaligned(t.get_badvaddr());
+            PAY.cold(index).trap.post(t.cause(), t.get_badvaddr());
             break;
          default:
             assert(0);
@@ -299,22 +402,24 @@ bool pipeline_t::execute_amo() {
    }
 
    // Record the loaded value in the payload buffer for checking purposes.
-   PAY.buf[index].C_value.dw = read_amo_value;
+   PAY.hot(index).C_value.dw = read_amo_value;
 
    // Write the loaded value to the destination physical register.
-   assert(PAY.buf[index].C_valid);
-   REN->write(PAY.buf[index].C_phys_reg, PAY.buf[index].C_value.dw);
+   assert(PAY.hot(index).C_valid);
+   REN->write(PAY.hot(index).C_phys_reg, PAY.hot(index).C_value.dw);
 
-   return(exception);
+   return(cause);
 }
 
 
-bool pipeline_t::execute_csr() {
+uint64_t pipeline_t::execute_csr() {
    unsigned int index = PAY.head;
-   insn_t inst = PAY.buf[index].inst;
-   pipeline_t *p = this; // *p is assumed by the validate_csr and require_supervisor macros.
+   insn_t inst = PAY.cold(index).inst;
    int csr;
-   bool exception = false;
+   uint64_t cause = TRAP_NONE;
+
+   // Execute the system instruction at the head of the Active List.
+   // Returns the cause of its fault, or TRAP_NONE.
 
    // CSR instructions:
    // 1. read the addressed CSR and write its old value into a destination register,
@@ -323,43 +428,38 @@ bool pipeline_t::execute_csr() {
    reg_t old_value;
    reg_t new_value;
 
-   try {
-      if (inst.funct3() != FN3_SC_SB) {
+   if (inst.funct3() != FN3_SC_SB) {
+      cause = check_csr(PAY.cold(index).CSR_addr, ((inst.funct3() != FN3_SET) || (PAY.cold(index).A_log_reg != 0)), csr);
+      if (cause == TRAP_NONE) {
          switch (inst.funct3()) {
             case FN3_CLR:
-               csr = validate_csr(PAY.buf[index].CSR_addr, true);
 	       old_value = get_pcr(csr);
-               new_value = (old_value & ~PAY.buf[index].A_value.dw);
+               new_value = (old_value & ~PAY.hot(index).A_value.dw);
                set_pcr(csr, new_value);
                break;
             case FN3_RW:
-               csr = validate_csr(PAY.buf[index].CSR_addr, true);
 	       old_value = get_pcr(csr);
-               new_value = PAY.buf[index].A_value.dw;
+               new_value = PAY.hot(index).A_value.dw;
                set_pcr(csr, new_value);
                break;
             case FN3_SET:
-               csr = validate_csr(PAY.buf[index].CSR_addr, (PAY.buf[index].A_log_reg != 0));
 	       old_value = get_pcr(csr);
-               new_value = (old_value | PAY.buf[index].A_value.dw);
+               new_value = (old_value | PAY.hot(index).A_value.dw);
                set_pcr(csr, new_value);
                break;
             case FN3_CLR_IMM:
-               csr = validate_csr(PAY.buf[index].CSR_addr, true);
 	       old_value = get_pcr(csr);
-               new_value = (old_value & ~(reg_t)PAY.buf[index].A_log_reg);
+               new_value = (old_value & ~(reg_t)PAY.cold(index).A_log_reg);
                set_pcr(csr, new_value);
                break;
             case FN3_RW_IMM:
-               csr = validate_csr(PAY.buf[index].CSR_addr, true);
 	       old_value = get_pcr(csr);
-               new_value = (reg_t)PAY.buf[index].A_log_reg;
+               new_value = (reg_t)PAY.cold(index).A_log_reg;
                set_pcr(csr, new_value);
                break;
             case FN3_SET_IMM:
-               csr = validate_csr(PAY.buf[index].CSR_addr, true);
 	       old_value = get_pcr(csr);
-               new_value = (old_value | (reg_t)PAY.buf[index].A_log_reg);
+               new_value = (old_value | (reg_t)PAY.cold(index).A_log_reg);
                set_pcr(csr, new_value);
                break;
             default:
@@ -367,37 +467,56 @@ bool pipeline_t::execute_csr() {
                break;
          }
       }
-      else if (inst.funct12() == FN12_SRET) {
-         // This is a macro defined in decode.h.
-         // This will throw a privileged_instruction trap if processor not in supervisor mode.
-         require_supervisor; 
-         csr = validate_csr(PAY.buf[index].CSR_addr, true);
+   }
+   else if (inst.funct12() == FN12_SRET) {
+      // Privileged instruction: the processor must be in supervisor mode.
+      // This is checked explicitly instead of with the require_supervisor macro (decode.h), which throws.
+      if (!(get_state()->sr & SR_S))
+         cause = CAUSE_PRIVILEGED_INSTRUCTION;
+      else
+         cause = check_csr(PAY.cold(index).CSR_addr, true, csr);
+
+      if (cause == TRAP_NONE) {
          old_value = get_pcr(csr);
          new_value = ((old_value & ~(SR_S | SR_EI)) | ((old_value & SR_PS) ? SR_S : 0) | ((old_value & SR_PEI) ? SR_EI : 0));
          set_pcr(csr, new_value);
       }
-      else {
-         // SCALL and SBREAK.
-         // These skip the IQ and execution lanes (completed in Dispatch Stage).
-         assert(0);
-      }
+   }
+   else {
+      // SCALL and SBREAK.
+      // These skip the IQ and execution lanes (completed in Dispatch Stage).
+      assert(0);
+   }
 
-      if (PAY.buf[index].C_valid) {
-         // Write the result (old value of CSR) to the payload buffer for checking purposes.
-         PAY.buf[index].C_value.dw = old_value;
-         // Write the result (old value of CSR) to the physical destination register.
-         REN->write(PAY.buf[index].C_phys_reg, PAY.buf[index].C_value.dw);
-      }
+   if (cause != TRAP_NONE) {
+      PAY.cold(index).trap.post(cause);
+   }
+   else if (PAY.hot(index).C_valid) {
+      // Write the result (old value of CSR) to the payload buffer for checking purposes.
+      PAY.hot(index).C_value.dw = old_value;
+      // Write the result (old value of CSR) to the physical destination register.
+      REN->write(PAY.hot(index).C_phys_reg, PAY.hot(index).C_value.dw);
+   }
+
+   return(cause);
+}
+
+
+uint64_t pipeline_t::check_csr(int which, bool write, int& csr) {
+   pipeline_t *p = this; // *p is assumed by the validate_csr macro.
+
+   // Check access to the addressed CSR. Returns the cause of the fault, or TRAP_NONE (then 'csr' is set).
+   // The check is the validate_csr macro (decode.h), which signals a fault or a request to serialize
+   // by throwing: this is the only place in execute_csr() where exceptions remain, and they are
+   // converted to a status here.
+   try {
+      csr = validate_csr(which, write);
    }
    catch (trap_t& t) {
-      exception = true;
       switch (t.cause()) {
          case CAUSE_PRIVILEGED_INSTRUCTION:
-            PAY.buf[index].trap = new trap_privileged_instruction();
-            break;
          case CAUSE_FP_DISABLED:
-            PAY.buf[index].trap = new trap_fp_disabled();
-            break;
+            return(t.cause());
          default:
             fflush(0);
             assert(0);
@@ -405,10 +524,65 @@ bool pipeline_t::execute_csr() {
       }
    }
    catch (serialize_t& s) {
-      exception = true;
-      PAY.buf[index].trap = new trap_csr_instruction();
+      return(CAUSE_CSR_INSTRUCTION);
    }
 
-   return(exception);
+   return(TRAP_NONE);
 }
 
+
+reg_t pipeline_t::take_trap_record(trap_record_t& rec, reg_t epc) {
+   // Rebuild the trap object on the stack from the by-value trap record, and take it.
+   // Only traps that reach retirement pay for constructing a trap object; nothing is
+   // allocated on the heap.
+   switch (rec.cause) {
+      case CAUSE_MISALIGNED_FETCH: {
+         trap_instruction_address_misaligned t(rec.badvaddr);
+         return(take_trap(t, epc));
+      }
+      case CAUSE_FAULT_FETCH: {
+         trap_instruction_access_fault t(rec.badvaddr);
+         return(take_trap(t, epc));
+      }
+      case CAUSE_ILLEGAL_INSTRUCTION: {
+         trap_illegal_instruction t;
+         return(take_trap(t, epc));
+      }
+      case CAUSE_PRIVILEGED_INSTRUCTION: {
+         trap_privileged_instruction t;
+         return(take_trap(t, epc));
+      }
+      case CAUSE_FP_DISABLED: {
+         trap_fp_disabled t;
+         return(take_trap(t, epc));
+      }
+      case CAUSE_SYSCALL: {
+         trap_syscall t;
+         return(take_trap(t, epc));
+      }
+      case CAUSE_BREAKPOINT: {
+         trap_breakpoint t;
+         return(take_trap(t, epc));
+      }
+      case CAUSE_MISALIGNED_LOAD: {
+         trap_load_address_misaligned t(rec.badvaddr);
+         return(take_trap(t, epc));
+      }
+      case CAUSE_MISALIGNED_STORE: {
+         trap_store_address_misaligned t(rec.badvaddr);
+         return(take_trap(t, epc));
+      }
+      case CAUSE_FAULT_LOAD: {
+         trap_load_access_fault t(rec.badvaddr);
+         return(take_trap(t, epc));
+      }
+      case CAUSE_FAULT_STORE: {
+         trap_store_access_fault t(rec.badvaddr);
+         return(take_trap(t, epc));
+      }
+      default:
+         fflush(0);
+         assert(0);
+         return(epc);
+   }
+}
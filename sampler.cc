@@ -0,0 +1,111 @@
+#include "sampler.h"
+#include <math.h>
+
+sampler::sampler(uint64_t period, uint64_t warmup_length, uint64_t unit_length,
+                 double z, double target_error, uint64_t min_samples)
+{
+    assert((period == 0) || (unit_length > 0));
+    assert((period == 0) || (period >= (warmup_length + unit_length)));
+    this->period = period;
+    this->warmup_length = warmup_length;
+    this->unit_length = unit_length;
+    this->z = z;
+    this->target_error = target_error;
+    this->min_samples = ((min_samples < 2) ? 2 : min_samples);
+
+    n_samples = 0;
+    sum = 0.0;
+    sum_sq = 0.0;
+
+    ////simulation starts in the detailed pipeline////
+    begin_detailed(0);
+}
+
+void sampler::begin_detailed(uint64_t cycle)
+{
+    count = 0;
+    if (warmup_length > 0)
+    {
+        phase = SAMPLE_WARMUP;
+    }
+    else
+    {
+        phase = SAMPLE_MEASURE;
+        unit_start_cycle = cycle;
+    }
+}
+
+bool sampler::retire(uint64_t cycle)
+{
+    if (!enabled())
+        return false;
+
+    assert(detailed());
+    count++;
+
+    if (phase == SAMPLE_WARMUP)
+    {
+        if (count == warmup_length)
+        {
+            phase = SAMPLE_MEASURE;
+            count = 0;
+            unit_start_cycle = cycle;
+        }
+        return false;
+    }
+
+    if (count < unit_length)
+        return false;
+
+    ////end of the measurement unit: record one CPI sample////
+    double cpi = (double)(cycle - unit_start_cycle) / (double)unit_length;
+    n_samples++;
+    sum += cpi;
+    sum_sq += (cpi * cpi);
+
+    phase = SAMPLE_FUNCTIONAL;
+    count = 0;
+    return true;
+}
+
+double sampler::mean_cpi()
+{
+    return (n_samples ? (sum / (double)n_samples) : 0.0);
+}
+
+double sampler::half_width()
+{
+    if (n_samples < 2)
+        return 0.0;
+
+    double n = (double)n_samples;
+    double var = (sum_sq - (sum * sum) / n) / (n - 1.0);
+    if (var < 0.0)
+        var = 0.0;	// rounding
+    return (z * sqrt(var / n));
+}
+
+double sampler::relative_error()
+{
+    double mean = mean_cpi();
+    return ((mean > 0.0) ? (half_width() / mean) : 0.0);
+}
+
+bool sampler::done()
+{
+    return (enabled() && (n_samples >= min_samples) && (relative_error() <= target_error));
+}
+
+void sampler::report(FILE *fp)
+{
+    if (!enabled())
+        return;
+
+    fprintf(fp, "SAMPLING: period = %" PRIu64 ", warmup = %" PRIu64 ", unit = %" PRIu64 " instructions\n",
+            period, warmup_length, unit_length);
+    fprintf(fp, "SAMPLING: samples = %" PRIu64 "\n", n_samples);
+    fprintf(fp, "SAMPLING: CPI = %.4f +/- %.4f (z = %.2f, relative error = %.2f%%, target = %.2f%%)\n",
+            mean_cpi(), half_width(), z, 100.0*relative_error(), 100.0*target_error);
+    fprintf(fp, "SAMPLING: IPC = %.4f\n", ((mean_cpi() > 0.0) ? (1.0 / mean_cpi()) : 0.0));
+    fprintf(fp, "SAMPLING: target error %s\n", (done() ? "met" : "NOT met"));
+}
@@ -0,0 +1,105 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+/////////////////////////////////////////////////////////////////////
+// Phases of a sampling period.
+// SAMPLE_WARMUP:     detailed simulation, not measured (warms the
+//                    microarchitectural state that functional warming
+//                    does not cover, e.g., the pipeline itself).
+// SAMPLE_MEASURE:    detailed simulation, measured.
+// SAMPLE_FUNCTIONAL: functional simulation until the next period.
+/////////////////////////////////////////////////////////////////////
+enum sample_phase {
+	SAMPLE_WARMUP,
+	SAMPLE_MEASURE,
+	SAMPLE_FUNCTIONAL
+};
+
+class sampler {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// SMARTS-style periodic sampling.
+	//
+	// Every 'period' instructions, the detailed pipeline simulates
+	// 'warmup_length' instructions (not measured) followed by a
+	// measurement unit of 'unit_length' instructions. The remaining
+	// instructions of the period are simulated functionally.
+	//
+	// Each measurement unit yields one CPI sample. The mean CPI is
+	// reported with a confidence interval of +/- z * s / sqrt(n), where
+	// s is the sample standard deviation and n the number of samples.
+	// Sampling is done once the relative half-width of the interval is
+	// within 'target_error' (after at least 'min_samples' samples).
+	/////////////////////////////////////////////////////////////////////
+	uint64_t period;		// 0: sampling disabled
+	uint64_t warmup_length;
+	uint64_t unit_length;
+	double z;
+	double target_error;
+	uint64_t min_samples;
+
+	sample_phase phase;
+	uint64_t count;			// instructions retired in the current phase
+	uint64_t unit_start_cycle;
+
+	/////////////////////////////////////////////////////////////////////
+	// CPI samples.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t n_samples;
+	double sum;
+	double sum_sq;
+
+public:
+	/////////////////////////////////////////////////////////////////////
+	// Inputs:
+	// 1. period: instructions per sampling period (0 disables sampling).
+	// 2. warmup_length: detailed, unmeasured instructions per period.
+	// 3. unit_length: measured instructions per period.
+	// 4. z: confidence coefficient (e.g., 1.96 for 95% confidence).
+	// 5. target_error: target relative half-width of the confidence
+	//    interval (e.g., 0.03 for +/- 3%).
+	// 6. min_samples: minimum number of samples before done() can be true.
+	/////////////////////////////////////////////////////////////////////
+	sampler(uint64_t period, uint64_t warmup_length, uint64_t unit_length,
+	        double z, double target_error, uint64_t min_samples);
+
+	bool enabled() {return (period > 0);}
+
+	/////////////////////////////////////////////////////////////////////
+	// 'true' while the detailed pipeline is being simulated.
+	/////////////////////////////////////////////////////////////////////
+	bool detailed() {return (phase != SAMPLE_FUNCTIONAL);}
+
+	/////////////////////////////////////////////////////////////////////
+	// Start the detailed window of the next period (after the
+	// architectural state of the functional simulator was injected into
+	// the pipeline).
+	/////////////////////////////////////////////////////////////////////
+	void begin_detailed(uint64_t cycle);
+
+	/////////////////////////////////////////////////////////////////////
+	// Called for each instruction retired by the detailed pipeline.
+	// Returns 'true' if the instruction ends the detailed window: the
+	// caller must then drain the pipeline (squash everything after the
+	// instruction, leaving the committed state in the AMT) and switch
+	// to functional simulation for functional_length() instructions.
+	/////////////////////////////////////////////////////////////////////
+	bool retire(uint64_t cycle);
+	uint64_t functional_length() {return (period - warmup_length - unit_length);}
+
+	/////////////////////////////////////////////////////////////////////
+	// Results.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t samples() {return n_samples;}
+	double mean_cpi();
+	double half_width();		// of the confidence interval
+	double relative_error();	// half_width() / mean_cpi()
+
+	/////////////////////////////////////////////////////////////////////
+	// 'true' once the target error bound is met: the run can stop.
+	/////////////////////////////////////////////////////////////////////
+	bool done();
+
+	void report(FILE *fp);
+};
@@ -0,0 +1,117 @@
+#include "shadow_renamer.h"
+
+shadow_renamers::shadow_renamers(uint64_t n_log_regs, uint64_t real_phys_regs, uint64_t real_branches,
+                                 unsigned int n_shadows, const uint64_t *phys_regs, const uint64_t *branches)
+{
+    this->n_log_regs = n_log_regs;
+    this->real_phys_regs = real_phys_regs;
+    this->real_branches = real_branches;
+    this->n_shadows = n_shadows;
+
+    shadows = new Shadow[n_shadows];
+    for (unsigned int s = 0; s < n_shadows; s++)
+    {
+        assert(phys_regs[s] > n_log_regs);
+        assert((1 <= branches[s]) && (branches[s] <= 64));
+        shadows[s].n_phys_regs = phys_regs[s];
+        shadows[s].n_branches = branches[s];
+        shadows[s].stall_reg_cycles = 0;
+        shadows[s].stall_branch_cycles = 0;
+        shadows[s].stall_dispatch_cycles = 0;
+    }
+
+    real_stall_reg_cycles = 0;
+    real_stall_branch_cycles = 0;
+    real_stall_dispatch_cycles = 0;
+}
+
+shadow_renamers::~shadow_renamers()
+{
+    delete[] shadows;
+}
+
+void shadow_renamers::resize(uint64_t real_phys_regs, uint64_t real_branches)
+{
+    assert(real_phys_regs > n_log_regs);
+    assert((1 <= real_branches) && (real_branches <= 64));
+    this->real_phys_regs = real_phys_regs;
+    this->real_branches = real_branches;
+
+    for (unsigned int s = 0; s < n_shadows; s++)
+    {
+        shadows[s].stall_reg_cycles = 0;
+        shadows[s].stall_branch_cycles = 0;
+        shadows[s].stall_dispatch_cycles = 0;
+    }
+    real_stall_reg_cycles = 0;
+    real_stall_branch_cycles = 0;
+    real_stall_dispatch_cycles = 0;
+}
+
+bool shadow_renamers::estimated(unsigned int s)
+{
+    return ((shadows[s].n_phys_regs >= real_phys_regs) && (shadows[s].n_branches >= real_branches));
+}
+
+void shadow_renamers::rename(uint64_t free_regs, uint64_t GBM, uint64_t bundle_dst, uint64_t bundle_branch)
+{
+    uint64_t used_branches = __builtin_popcountll(GBM);
+
+    ////the real renamer checks branches first (see rename2())////
+    if (used_branches + bundle_branch > real_branches)
+        real_stall_branch_cycles++;
+    else if (bundle_dst > free_regs)
+        real_stall_reg_cycles++;
+
+    for (unsigned int s = 0; s < n_shadows; s++)
+    {
+        if (!estimated(s))
+            continue;
+
+        ////free' = free + (P' - P); P' >= P, so free' >= free////
+        uint64_t shadow_free = free_regs + (shadows[s].n_phys_regs - real_phys_regs);
+
+        if (used_branches + bundle_branch > shadows[s].n_branches)
+            shadows[s].stall_branch_cycles++;
+        else if (bundle_dst > shadow_free)
+            shadows[s].stall_reg_cycles++;
+    }
+}
+
+void shadow_renamers::dispatch(uint64_t al_size, uint64_t bundle_inst, uint64_t cycles)
+{
+    if (al_size + bundle_inst > real_phys_regs - n_log_regs)
+        real_stall_dispatch_cycles += cycles;
+
+    for (unsigned int s = 0; s < n_shadows; s++)
+    {
+        if (!estimated(s))
+            continue;
+
+        if (al_size + bundle_inst > shadows[s].n_phys_regs - n_log_regs)
+            shadows[s].stall_dispatch_cycles += cycles;
+    }
+}
+
+void shadow_renamers::dump_stats(FILE *fp)
+{
+    if (!enabled())
+        return;
+
+    fprintf(fp, "SHADOW RENAMERS (first-order estimate, for renamers at least as large as the real one; stalls do not feed back into the instruction stream):\n");
+    fprintf(fp, "SHADOW: %10s %10s %16s %16s %16s\n", "phys_regs", "branches", "stall_reg", "stall_branch", "stall_dispatch");
+    fprintf(fp, "SHADOW: %10" PRIu64 " %10" PRIu64 " %16" PRIu64 " %16" PRIu64 " %16" PRIu64 "  (real)\n",
+            real_phys_regs, real_branches, real_stall_reg_cycles, real_stall_branch_cycles, real_stall_dispatch_cycles);
+    for (unsigned int s = 0; s < n_shadows; s++)
+    {
+        if (!estimated(s))
+        {
+            fprintf(fp, "SHADOW: %10" PRIu64 " %10" PRIu64 "  not estimated (smaller than the real renamer)\n",
+                    shadows[s].n_phys_regs, shadows[s].n_branches);
+            continue;
+        }
+        fprintf(fp, "SHADOW: %10" PRIu64 " %10" PRIu64 " %16" PRIu64 " %16" PRIu64 " %16" PRIu64 "\n",
+                shadows[s].n_phys_regs, shadows[s].n_branches,
+                shadows[s].stall_reg_cycles, shadows[s].stall_branch_cycles, shadows[s].stall_dispatch_cycles);
+    }
+}
@@ -0,0 +1,99 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+class shadow_renamers {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// Shadow renamers.
+	//
+	// Each shadow renamer is a renamer size (number of physical
+	// registers, number of checkpoints) that is evaluated alongside the
+	// real renamer, in the same simulation. A shadow renamer does not
+	// rename anything: it observes the real renamer's occupancy whenever
+	// the Rename2 and Dispatch Stages check for resources, and derives
+	// its own occupancy from it:
+	// * free physical registers: the real free list length plus the
+	//   difference in the number of physical registers;
+	// * free checkpoints: its number of checkpoints minus the number of
+	//   bits set in the real GBM;
+	// * Active List capacity: its number of physical registers minus the
+	//   number of logical registers.
+	// It counts the cycles in which it would have stalled in stall_reg(),
+	// stall_branch() or stall_dispatch().
+	//
+	// This is a first-order estimate: a shadow stall does not delay the
+	// instruction stream that all shadows observe (the real one).
+	//
+	// Only shadows at least as large as the real renamer (in both
+	// physical registers and checkpoints) are estimated. The real
+	// occupancy can exceed a smaller shadow's capacity, which that
+	// shadow could never reach, so its counts would be meaningless:
+	// such shadows are reported as not estimated.
+	/////////////////////////////////////////////////////////////////////
+	struct Shadow
+	{
+		uint64_t n_phys_regs;
+		uint64_t n_branches;
+		uint64_t stall_reg_cycles;
+		uint64_t stall_branch_cycles;
+		uint64_t stall_dispatch_cycles;
+	};
+	struct Shadow *shadows;
+	unsigned int n_shadows;
+
+	uint64_t n_log_regs;
+	uint64_t real_phys_regs;
+	uint64_t real_branches;
+
+	// Is shadow 's' at least as large as the real renamer?
+	bool estimated(unsigned int s);
+
+	/////////////////////////////////////////////////////////////////////
+	// Stall cycles of the real renamer, for comparison.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t real_stall_reg_cycles;
+	uint64_t real_stall_branch_cycles;
+	uint64_t real_stall_dispatch_cycles;
+
+public:
+	/////////////////////////////////////////////////////////////////////
+	// Inputs:
+	// 1. n_log_regs, real_phys_regs, real_branches: sizes of the real
+	//    renamer.
+	// 2. n_shadows: number of shadow renamers (0: disabled).
+	// 3. phys_regs[s], branches[s]: size of shadow renamer 's'.
+	/////////////////////////////////////////////////////////////////////
+	shadow_renamers(uint64_t n_log_regs, uint64_t real_phys_regs, uint64_t real_branches,
+	                unsigned int n_shadows, const uint64_t *phys_regs, const uint64_t *branches);
+	~shadow_renamers();
+
+	bool enabled() {return (n_shadows > 0);}
+
+	/////////////////////////////////////////////////////////////////////
+	// The real renamer was reconfigured to 'real_phys_regs' physical
+	// registers and 'real_branches' checkpoints. The stall counts are
+	// restarted, so that the report compares the shadows with one real
+	// renamer size.
+	/////////////////////////////////////////////////////////////////////
+	void resize(uint64_t real_phys_regs, uint64_t real_branches);
+
+	/////////////////////////////////////////////////////////////////////
+	// Rename2 Stage: the real renamer has 'free_regs' free physical
+	// registers and the checkpoints in 'GBM' in use; the rename bundle
+	// needs 'bundle_dst' registers and 'bundle_branch' checkpoints.
+	/////////////////////////////////////////////////////////////////////
+	void rename(uint64_t free_regs, uint64_t GBM, uint64_t bundle_dst, uint64_t bundle_branch);
+
+	/////////////////////////////////////////////////////////////////////
+	// Dispatch Stage: the real Active List holds 'al_size' instructions;
+	// the dispatch bundle has 'bundle_inst' instructions. The same check
+	// repeats for 'cycles' cycles (skipped idle cycles).
+	/////////////////////////////////////////////////////////////////////
+	void dispatch(uint64_t al_size, uint64_t bundle_inst, uint64_t cycles = 1);
+
+	/////////////////////////////////////////////////////////////////////
+	// Report estimated stall cycles per renamer size.
+	/////////////////////////////////////////////////////////////////////
+	void dump_stats(FILE *fp);
+};
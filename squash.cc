@@ -1,9 +1,10 @@
 #include "pipeline.h"
+#include "trace_log.h"
+#include "timeline.h"
+#include "squash_epoch.h"
 
 
 void pipeline_t::squash_complete(reg_t jump_PC) {
-	unsigned int i, j;
-
 	//////////////////////////
 	// Fetch Stage
 	//////////////////////////
@@ -11,7 +12,9 @@ void pipeline_t::squash_complete(reg_t jump_PC) {
 	//pc = offending_PC + SS_INST_SIZE;
 	//pc = INCREMENT_PC(offending_PC);
 	pc = jump_PC;  //Jump to the exception vector or next instruction
-  LOG(fetch_log,cycle,PAY.buf[PAY.head].sequence,PAY.buf[PAY.head].pc,"Exception, Redirect to 0x%016" PRIx64 "",pc);
+  if (TRACE_ON(TRACE_EVENTS))
+    LOG(fetch_log,cycle,PAY.cold(PAY.head).sequence,PAY.cold(PAY.head).pc,"Exception, Redirect to 0x%016" PRIx64 "",pc);
+  TRACE(TRACE_EVENTS, TRACE_EV_REDIRECT, id, cycle, PAY.cold(PAY.head).sequence, PAY.cold(PAY.head).pc, pc);
 
 
 	next_fetch_cycle = (cycle_t)0;
@@ -23,15 +26,18 @@ void pipeline_t::squash_complete(reg_t jump_PC) {
   clear_fetch_exception();
   clear_fetch_amo();
   clear_fetch_csr();
-  ifprintf(logging_on,stderr,"RETIRE: Clearing fetch_exception flag %u\n",fetch_exception);
+  if (TRACE_ON(TRACE_EVENTS))
+    ifprintf(logging_on,stderr,"RETIRE: Clearing fetch_exception flag %u\n",fetch_exception);
+  TRACE(TRACE_EVENTS, TRACE_EV_CLEAR_FETCH_EXC, id, cycle, PAY.cold(PAY.head).sequence, PAY.cold(PAY.head).pc, fetch_exception);
 
 	//////////////////////////
-	// Decode Stage
+	// Pipeline registers
 	//////////////////////////
 
-	for (i = 0; i < fetch_width; i++) {
-		DECODE[i].valid = false;
-	}
+	// Squash the Decode, Rename2, Dispatch, Register Read, Execute and Writeback
+	// pipeline registers at once, regardless of machine width: all registers made
+	// valid in the old epoch now read as invalid (see squash_epoch.h).
+	squash_epoch++;
 
 	//////////////////////////
 	// Rename1 Stage
@@ -43,44 +49,33 @@ void pipeline_t::squash_complete(reg_t jump_PC) {
 	// Rename2 Stage
 	//////////////////////////
 
-	for (i = 0; i < dispatch_width; i++) {
-		RENAME2[i].valid = false;
-	}
-
         //
         // FIX_ME #17c
         // Squash the renamer.
         //
         REN->squash();
 
-	//////////////////////////
-	// Dispatch Stage
-	//////////////////////////
-
-	for (i = 0; i < dispatch_width; i++) {
-		DISPATCH[i].valid = false;
-	}
-
 	//////////////////////////
 	// Schedule Stage
 	//////////////////////////
 
 	IQ.flush();
+	WL.flush();
+	if (VALUE_PRED)
+		VP.flush();
+	STEER.flush();
+
+	// Pending correct resolutions are moot: the renamer was squashed to an empty GBM.
+	resolved_mask = 0;
 
 	//////////////////////////
-	// Register Read Stage
-	// Execute Stage
-	// Writeback Stage
+	// Load/Store Unit
 	//////////////////////////
 
-	for (i = 0; i < issue_width; i++) {
-		Execution_Lanes[i].rr.valid = false;
-		for (j = 0; j < Execution_Lanes[i].ex_depth; j++)
-		   Execution_Lanes[i].ex[j].valid = false;
-		Execution_Lanes[i].wb.valid = false;
-	}
-
 	LSU.flush();
+
+	// All in-flight instructions are squashed.
+	TIMELINE.squash_all(cycle);
 }
 
 
@@ -90,29 +85,7 @@ void pipeline_t::resolve(unsigned int branch_ID, bool correct) {
 	if (correct) {
 		// Instructions in the Rename2 through Writeback Stages have branch masks.
 		// The correctly-resolved branch's bit must be cleared in all branch masks.
-
-		for (i = 0; i < dispatch_width; i++) {
-			// Rename2 Stage:
-			CLEAR_BIT(RENAME2[i].branch_mask, branch_ID);
-
-			// Dispatch Stage:
-			CLEAR_BIT(DISPATCH[i].branch_mask, branch_ID);
-		}
-
-		// Schedule Stage:
-		IQ.clear_branch_bit(branch_ID);
-
-		for (i = 0; i < issue_width; i++) {
-			// Register Read Stage:
-			CLEAR_BIT(Execution_Lanes[i].rr.branch_mask, branch_ID);
-
-			// Execute Stage:
-			for (j = 0; j < Execution_Lanes[i].ex_depth; j++)
-			   CLEAR_BIT(Execution_Lanes[i].ex[j].branch_mask, branch_ID);
-
-			// Writeback Stage:
-			CLEAR_BIT(Execution_Lanes[i].wb.branch_mask, branch_ID);
-		}
+		clear_branch_mask(1ULL << branch_ID);
 	}
 	else {
 		// Squash all instructions in the Decode through Dispatch Stages.
@@ -139,24 +112,78 @@ void pipeline_t::resolve(unsigned int branch_ID, bool correct) {
 
 		// Schedule Stage:
 		IQ.squash(branch_ID);
+		WL.squash(branch_ID);
+		if (VALUE_PRED)
+			VP.squash(branch_ID);
+		STEER.squash(branch_ID);
 
 		for (i = 0; i < issue_width; i++) {
 			// Register Read Stage:
-			if (Execution_Lanes[i].rr.valid && BIT_IS_ONE(Execution_Lanes[i].rr.branch_mask, branch_ID)) {
+			if (REG_VALID(Execution_Lanes[i].rr) && BIT_IS_ONE(Execution_Lanes[i].rr.branch_mask, branch_ID)) {
 				Execution_Lanes[i].rr.valid = false;
 			}
 
 			// Execute Stage:
+			// Sub-stages are a rotating buffer, but squashing does not depend on their order:
+			// every physical slot is checked.
 			for (j = 0; j < Execution_Lanes[i].ex_depth; j++) {
-			   if (Execution_Lanes[i].ex[j].valid && BIT_IS_ONE(Execution_Lanes[i].ex[j].branch_mask, branch_ID)) {
+			   if (REG_VALID(Execution_Lanes[i].ex[j]) && BIT_IS_ONE(Execution_Lanes[i].ex[j].branch_mask, branch_ID)) {
 				Execution_Lanes[i].ex[j].valid = false;
 			   }
 			}
 
 			// Writeback Stage:
-			if (Execution_Lanes[i].wb.valid && BIT_IS_ONE(Execution_Lanes[i].wb.branch_mask, branch_ID)) {
+			if (REG_VALID(Execution_Lanes[i].wb) && BIT_IS_ONE(Execution_Lanes[i].wb.branch_mask, branch_ID)) {
 				Execution_Lanes[i].wb.valid = false;
 			}
 		}
 	}
 }
+
+
+void pipeline_t::clear_branch_mask(uint64_t mask) {
+	unsigned int i, j;
+
+	// Clear all bits of 'mask' in the branch masks of instructions in the Rename2 through
+	// Writeback Stages, in one sweep.
+
+	for (i = 0; i < dispatch_width; i++) {
+		// Rename2 Stage:
+		RENAME2[i].branch_mask &= ~mask;
+
+		// Dispatch Stage:
+		DISPATCH[i].branch_mask &= ~mask;
+	}
+
+	// Schedule Stage:
+	IQ.clear_branch_mask(mask);
+	WL.clear_branch_mask(mask);
+	if (VALUE_PRED)
+		VP.clear_branch_mask(mask);
+	STEER.clear_branch_mask(mask);
+
+	for (i = 0; i < issue_width; i++) {
+		// Register Read Stage:
+		Execution_Lanes[i].rr.branch_mask &= ~mask;
+
+		// Execute Stage (every physical slot of the rotating buffer):
+		for (j = 0; j < Execution_Lanes[i].ex_depth; j++)
+		   Execution_Lanes[i].ex[j].branch_mask &= ~mask;
+
+		// Writeback Stage:
+		Execution_Lanes[i].wb.branch_mask &= ~mask;
+	}
+}
+
+
+void pipeline_t::resolve_batch() {
+	// Apply all correct branch resolutions collected by the Writeback Stage: free their
+	// checkpoints in the renamer and clear their bits in all branch masks, in one sweep each.
+	// This must happen before Rename2 can reallocate the freed branch IDs, and before a
+	// mispredicted branch restores a checkpointed GBM.
+	if (resolved_mask) {
+		REN->resolve_mask(resolved_mask);
+		clear_branch_mask(resolved_mask);
+		resolved_mask = 0;
+	}
+}
@@ -0,0 +1,15 @@
+/////////////////////////////////////////////////////////////////////
+// Squash epoch.
+//
+// Every pipeline register (DECODE, RENAME2, DISPATCH, and each
+// Execution Lane's rr, ex[] and wb) records the squash epoch in which
+// it was made valid. A complete squash does not visit the pipeline
+// registers: it just increments pipeline_t::squash_epoch, which makes
+// every register written in an older epoch read as invalid.
+//
+// Use REG_VALID() to test a pipeline register and REG_SET_VALID() to
+// fill it. Invalidating a single register (e.g., after it advances,
+// or in a selective squash) still clears its valid bit directly.
+/////////////////////////////////////////////////////////////////////
+#define REG_VALID(r)		((r).valid && ((r).epoch == squash_epoch))
+#define REG_SET_VALID(r)	do { (r).valid = true; (r).epoch = squash_epoch; } while (0)
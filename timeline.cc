@@ -0,0 +1,110 @@
+#include "timeline.h"
+
+timeline TIMELINE;
+
+timeline::timeline()
+{
+    inflight = NULL;
+    valid = NULL;
+    n_inflight = 0;
+    buffer = NULL;
+    buffer_size = 0;
+    buffer_count = 0;
+    fp = NULL;
+    sample_period = 0;
+    sample_window = 0;
+}
+
+timeline::~timeline()
+{
+    close();
+}
+
+bool timeline::open(const char *path, unsigned int n_pay, unsigned int buffer_size,
+                    uint64_t sample_period, uint64_t sample_window)
+{
+    assert((n_pay > 0) && (buffer_size > 0));
+    assert(!sample_period || (sample_window > 0));
+    close();
+
+    fp = fopen(path, "wb");
+    if (!fp)
+        return false;
+
+    tl_header_t header;
+    header.magic = TL_MAGIC;
+    header.version = TL_VERSION;
+    fwrite(&header, sizeof(header), 1, fp);
+
+    n_inflight = n_pay;
+    inflight = new tl_rec_t[n_pay];
+    valid = new bool[n_pay];
+    for (unsigned int i = 0; i < n_pay; i++)
+        valid[i] = false;
+
+    this->buffer_size = buffer_size;
+    buffer = new tl_rec_t[buffer_size];
+    buffer_count = 0;
+
+    this->sample_period = sample_period;
+    this->sample_window = sample_window;
+    return true;
+}
+
+void timeline::close()
+{
+    if (fp)
+    {
+        flush_buffer();
+        fclose(fp);
+    }
+    fp = NULL;
+
+    delete[] inflight;
+    delete[] valid;
+    delete[] buffer;
+    inflight = NULL;
+    valid = NULL;
+    buffer = NULL;
+}
+
+void timeline::finish(unsigned int index, uint64_t cycle, bool squashed)
+{
+    inflight[index].cycle[TL_RETIRE] = cycle;
+    inflight[index].squashed = squashed;
+    valid[index] = false;
+
+    buffer[buffer_count] = inflight[index];
+    buffer_count++;
+    if (buffer_count == buffer_size)
+        flush_buffer();
+}
+
+void timeline::flush_buffer()
+{
+    if (buffer_count)
+        fwrite(buffer, sizeof(tl_rec_t), buffer_count, fp);
+    buffer_count = 0;
+}
+
+void timeline::squash_after(uint64_t sequence, uint64_t cycle)
+{
+    if (!fp)
+        return;
+    for (unsigned int i = 0; i < n_inflight; i++)
+    {
+        if (valid[i] && (inflight[i].sequence > sequence))
+            finish(i, cycle, true);
+    }
+}
+
+void timeline::squash_all(uint64_t cycle)
+{
+    if (!fp)
+        return;
+    for (unsigned int i = 0; i < n_inflight; i++)
+    {
+        if (valid[i])
+            finish(i, cycle, true);
+    }
+}
@@ -0,0 +1,132 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+/////////////////////////////////////////////////////////////////////
+// Pipeline stages recorded by the timeline.
+/////////////////////////////////////////////////////////////////////
+enum timeline_stage {
+	TL_RENAME2 = 0,
+	TL_DISPATCH,
+	TL_REG_READ,	// the instruction was issued the cycle before
+	TL_EXECUTE,	// final Execute sub-stage
+	TL_WRITEBACK,
+	TL_RETIRE,	// retired or squashed, see tl_rec_t::squashed
+	NUMBER_TL_STAGES
+};
+
+/////////////////////////////////////////////////////////////////////
+// One instruction of the timeline. A stage that the instruction never
+// reached has cycle 0.
+/////////////////////////////////////////////////////////////////////
+struct tl_rec_t {
+	uint64_t sequence;
+	uint64_t pc;
+	uint64_t cycle[NUMBER_TL_STAGES];
+	uint64_t squashed;	// 1: squashed, 0: retired
+};
+
+#define TL_MAGIC	0x454e494c454d4954ULL	// "TIMELINE"
+#define TL_VERSION	1
+
+struct tl_header_t {
+	uint64_t magic;
+	uint64_t version;
+};
+
+class timeline {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// In-flight instructions, indexed by PAY index.
+	/////////////////////////////////////////////////////////////////////
+	struct tl_rec_t *inflight;
+	bool *valid;
+	unsigned int n_inflight;
+
+	/////////////////////////////////////////////////////////////////////
+	// Output buffer, written to the file when full.
+	/////////////////////////////////////////////////////////////////////
+	struct tl_rec_t *buffer;
+	unsigned int buffer_size;
+	unsigned int buffer_count;
+	FILE *fp;
+
+	/////////////////////////////////////////////////////////////////////
+	// Sampling: record instruction 'seq' only if
+	// (seq % sample_period) < sample_window.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t sample_period;
+	uint64_t sample_window;
+
+	void finish(unsigned int index, uint64_t cycle, bool squashed);
+	void flush_buffer();
+
+public:
+	timeline();
+	~timeline();
+
+	/////////////////////////////////////////////////////////////////////
+	// Start recording into 'path'.
+	// Inputs:
+	// 1. n_pay: number of PAY entries.
+	// 2. buffer_size: number of records buffered before each write.
+	// 3. sample_period, sample_window: see above; period 0 records all.
+	/////////////////////////////////////////////////////////////////////
+	bool open(const char *path, unsigned int n_pay, unsigned int buffer_size,
+	          uint64_t sample_period, uint64_t sample_window);
+	void close();
+
+	bool enabled() {return(fp != NULL);}
+
+	/////////////////////////////////////////////////////////////////////
+	// Hooks.
+	// start():        instruction enters Rename2.
+	// stamp():        instruction reaches 'stage'.
+	// retire():       instruction retires (committed or exception).
+	// squash():       instruction is squashed.
+	// squash_after(): squash all in-flight instructions younger than
+	//                 'sequence' (branch misprediction).
+	// squash_all():   squash all in-flight instructions (full squash).
+	/////////////////////////////////////////////////////////////////////
+	void start(unsigned int index, uint64_t sequence, uint64_t pc, uint64_t cycle)
+	{
+		if (!fp)
+			return;
+		assert(index < n_inflight);
+		if (sample_period && ((sequence % sample_period) >= sample_window))
+			return;
+		valid[index] = true;
+		inflight[index].sequence = sequence;
+		inflight[index].pc = pc;
+		for (unsigned int s = 0; s < NUMBER_TL_STAGES; s++)
+			inflight[index].cycle[s] = 0;
+		inflight[index].cycle[TL_RENAME2] = cycle;
+		inflight[index].squashed = 0;
+	}
+
+	void stamp(unsigned int index, timeline_stage stage, uint64_t cycle)
+	{
+		if (fp && valid[index])
+			inflight[index].cycle[stage] = cycle;
+	}
+
+	void retire(unsigned int index, uint64_t cycle)
+	{
+		if (fp && valid[index])
+			finish(index, cycle, false);
+	}
+
+	void squash(unsigned int index, uint64_t cycle)
+	{
+		if (fp && valid[index])
+			finish(index, cycle, true);
+	}
+
+	void squash_after(uint64_t sequence, uint64_t cycle);
+	void squash_all(uint64_t cycle);
+};
+
+/////////////////////////////////////////////////////////////////////
+// The timeline recorder of the simulator (see timeline.cc).
+/////////////////////////////////////////////////////////////////////
+extern timeline TIMELINE;
@@ -0,0 +1,53 @@
+/////////////////////////////////////////////////////////////////////
+// Converts a binary timeline file (see timeline.h) to O3PipeView text,
+// which Konata and the gem5 pipeline viewer can read.
+//
+// Usage: timeline_convert <timeline file> [ticks per cycle]
+/////////////////////////////////////////////////////////////////////
+#include "timeline.h"
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+{
+    if ((argc != 2) && (argc != 3))
+    {
+        fprintf(stderr, "usage: %s <timeline file> [ticks per cycle]\n", argv[0]);
+        return 1;
+    }
+    uint64_t tpc = (argc == 3) ? strtoull(argv[2], NULL, 0) : 1;
+
+    FILE *fp = fopen(argv[1], "rb");
+    if (!fp)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    tl_header_t header;
+    if ((fread(&header, sizeof(header), 1, fp) != 1) || (header.magic != TL_MAGIC) || (header.version != TL_VERSION))
+    {
+        fprintf(stderr, "%s: not a timeline file (or unsupported version)\n", argv[1]);
+        return 1;
+    }
+
+    tl_rec_t r;
+    while (fread(&r, sizeof(r), 1, fp) == 1)
+    {
+        // The timeline starts at Rename2: fetch and decode are shown at the same cycle.
+        // Issue is the cycle before Register Read.
+        uint64_t issue = r.cycle[TL_REG_READ] ? (r.cycle[TL_REG_READ] - 1) : 0;
+        uint64_t complete = r.cycle[TL_WRITEBACK] ? r.cycle[TL_WRITEBACK] : r.cycle[TL_EXECUTE];
+
+        printf("O3PipeView:fetch:%" PRIu64 ":0x%016" PRIx64 ":0:%" PRIu64 ":0x%016" PRIx64 "\n",
+               r.cycle[TL_RENAME2] * tpc, r.pc, r.sequence, r.pc);
+        printf("O3PipeView:decode:%" PRIu64 "\n", r.cycle[TL_RENAME2] * tpc);
+        printf("O3PipeView:rename:%" PRIu64 "\n", r.cycle[TL_RENAME2] * tpc);
+        printf("O3PipeView:dispatch:%" PRIu64 "\n", r.cycle[TL_DISPATCH] * tpc);
+        printf("O3PipeView:issue:%" PRIu64 "\n", issue * tpc);
+        printf("O3PipeView:complete:%" PRIu64 "\n", complete * tpc);
+        printf("O3PipeView:retire:%" PRIu64 ":store:0\n", r.squashed ? 0 : (r.cycle[TL_RETIRE] * tpc));
+    }
+
+    fclose(fp);
+    return 0;
+}
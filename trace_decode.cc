@@ -0,0 +1,69 @@
+/////////////////////////////////////////////////////////////////////
+// Offline decoder for binary trace files written by trace_log.
+//
+// Usage: trace_decode <trace file>
+//
+// Prints the records still held in the ring, oldest first, one per
+// line: the "Cycle <n>: core <id>:" prefix of the text logs, then the
+// record's sequence number, PC, event name and argument. The records
+// are not a copy of the text logs, which are still written at their
+// trace points (see trace_log.h).
+/////////////////////////////////////////////////////////////////////
+#include "trace_log.h"
+#include <stdlib.h>
+
+static const char *event_name[NUMBER_TRACE_EVENTS] = {
+    "redirect",
+    "clear fetch exception",
+    "exception",
+    "exception (external)"
+};
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *fp = fopen(argv[1], "rb");
+    if (!fp)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    trace_header_t header;
+    if ((fread(&header, sizeof(header), 1, fp) != 1) || (header.magic != TRACE_MAGIC))
+    {
+        fprintf(stderr, "%s: not a trace file\n", argv[1]);
+        return 1;
+    }
+    if (header.version != TRACE_VERSION)
+    {
+        fprintf(stderr, "%s: unsupported trace version %" PRIu64 "\n", argv[1], header.version);
+        return 1;
+    }
+
+    trace_rec_t *records = new trace_rec_t[header.capacity];
+    if (fread(records, sizeof(trace_rec_t), header.capacity, fp) != header.capacity)
+    {
+        fprintf(stderr, "%s: truncated trace file\n", argv[1]);
+        return 1;
+    }
+    fclose(fp);
+
+    ////oldest record still in the ring////
+    uint64_t first = (header.count > header.capacity) ? (header.count - header.capacity) : 0;
+    for (uint64_t n = first; n < header.count; n++)
+    {
+        trace_rec_t &r = records[n % header.capacity];
+        const char *name = (r.event < NUMBER_TRACE_EVENTS) ? event_name[r.event] : "unknown";
+        printf("Cycle %" PRIu64 ": core %3u: seq %" PRIu64 " pc 0x%016" PRIx64 " %s 0x%016" PRIx64 "\n",
+               r.cycle, r.core, r.sequence, r.pc, name, r.arg);
+    }
+
+    delete[] records;
+    return 0;
+}
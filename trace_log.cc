@@ -0,0 +1,70 @@
+#include "trace_log.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+trace_log TRACE_LOG;
+
+trace_log::trace_log()
+{
+    fd = -1;
+    map = NULL;
+    map_size = 0;
+    header = NULL;
+    records = NULL;
+}
+
+trace_log::~trace_log()
+{
+    close();
+}
+
+bool trace_log::open(const char *path, uint64_t capacity)
+{
+    assert(capacity > 0);
+    close();
+
+    fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    map_size = sizeof(trace_header_t) + capacity * sizeof(trace_rec_t);
+    if (ftruncate(fd, map_size) != 0)
+    {
+        close();
+        return false;
+    }
+
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        map = NULL;
+        close();
+        return false;
+    }
+
+    header = (trace_header_t *)map;
+    records = (trace_rec_t *)((char *)map + sizeof(trace_header_t));
+    header->magic = TRACE_MAGIC;
+    header->version = TRACE_VERSION;
+    header->capacity = capacity;
+    header->count = 0;
+    return true;
+}
+
+void trace_log::close()
+{
+    if (map)
+    {
+        msync(map, map_size, MS_SYNC);
+        munmap(map, map_size);
+    }
+    if (fd >= 0)
+        ::close(fd);
+
+    fd = -1;
+    map = NULL;
+    map_size = 0;
+    header = NULL;
+    records = NULL;
+}
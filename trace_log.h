@@ -0,0 +1,115 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+/////////////////////////////////////////////////////////////////////
+// Compile-time trace level.
+//
+// Trace points whose level is above TRACE_LEVEL are compiled out:
+// the condition of the TRACE() macro is a compile-time constant, so
+// a disabled trace point costs nothing, not even a runtime check.
+//
+// Build with -DTRACE_LEVEL=<n> to select the level. The default,
+// TRACE_EVENTS, keeps the simulator's existing event logs.
+//
+// The text logs at a trace point are kept at the trace point's level
+// with TRACE_ON(), so that they are compiled out along with it:
+//	if (TRACE_ON(TRACE_EVENTS))
+//		ifprintf(logging_on, execute_log, ...);
+/////////////////////////////////////////////////////////////////////
+#define TRACE_OFF	0
+#define TRACE_EVENTS	1	// rare events: exceptions, redirects
+#define TRACE_VERBOSE	2	// per-instruction events
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL	TRACE_EVENTS
+#endif
+
+#define TRACE_ON(level)	((level) <= TRACE_LEVEL)
+
+/////////////////////////////////////////////////////////////////////
+// Trace events.
+/////////////////////////////////////////////////////////////////////
+enum trace_event {
+	TRACE_EV_REDIRECT = 0,		// squash_complete(): fetch redirected, arg = new PC
+	TRACE_EV_CLEAR_FETCH_EXC,	// squash_complete(): fetch exception flag cleared, arg = old flag
+	TRACE_EV_EXCEPTION,		// execute(): ALU exception, arg = cause
+	TRACE_EV_EXCEPTION_EXTERNAL,	// execute(): exception thrown from outside the micro sim, arg = cause
+	NUMBER_TRACE_EVENTS
+};
+
+/////////////////////////////////////////////////////////////////////
+// Fixed-size binary trace record.
+/////////////////////////////////////////////////////////////////////
+struct trace_rec_t {
+	uint64_t cycle;
+	uint64_t sequence;
+	uint64_t pc;
+	uint64_t arg;
+	uint32_t event;
+	uint32_t core;
+};
+
+/////////////////////////////////////////////////////////////////////
+// Header at the start of the trace file.
+// 'count' is the total number of records ever written; the ring holds
+// the last 'capacity' of them, record 'n' being at slot n % capacity.
+/////////////////////////////////////////////////////////////////////
+#define TRACE_MAGIC	0x3132374543415254ULL	// "TRACE721"
+#define TRACE_VERSION	1
+
+struct trace_header_t {
+	uint64_t magic;
+	uint64_t version;
+	uint64_t capacity;
+	uint64_t count;
+};
+
+class trace_log {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// The trace file is memory-mapped: writing a record is a plain
+	// store into the mapping, and the kernel writes pages back lazily.
+	/////////////////////////////////////////////////////////////////////
+	int fd;
+	void *map;
+	uint64_t map_size;
+	struct trace_header_t *header;
+	struct trace_rec_t *records;
+
+public:
+	trace_log();
+	~trace_log();
+
+	/////////////////////////////////////////////////////////////////////
+	// Create the trace file with room for 'capacity' records.
+	// Returns 'false' if the file cannot be created or mapped.
+	/////////////////////////////////////////////////////////////////////
+	bool open(const char *path, uint64_t capacity);
+	void close();
+
+	void emit(uint32_t event, uint32_t core, uint64_t cycle, uint64_t sequence, uint64_t pc, uint64_t arg)
+	{
+		if (!header)
+			return;
+		struct trace_rec_t *r = &records[header->count % header->capacity];
+		r->cycle = cycle;
+		r->sequence = sequence;
+		r->pc = pc;
+		r->arg = arg;
+		r->event = event;
+		r->core = core;
+		header->count++;
+	}
+};
+
+/////////////////////////////////////////////////////////////////////
+// The trace log of the simulator (see trace_log.cc).
+/////////////////////////////////////////////////////////////////////
+extern trace_log TRACE_LOG;
+
+#define TRACE(level, event, core, cycle, sequence, pc, arg) \
+	do { \
+		if (TRACE_ON(level)) \
+			TRACE_LOG.emit((event), (core), (cycle), (sequence), (pc), (arg)); \
+	} while (0)
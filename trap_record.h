@@ -0,0 +1,30 @@
+#include <inttypes.h>
+
+/////////////////////////////////////////////////////////////////////
+// Fault status.
+//
+// Execution paths that report a fault by returning its cause (ALU,
+// AMO, CSR) return TRAP_NONE if there is no fault. No trap cause has
+// this value.
+/////////////////////////////////////////////////////////////////////
+#define TRAP_NONE	(~(uint64_t)0)
+
+/////////////////////////////////////////////////////////////////////
+// Trap record.
+//
+// An instruction that raises an exception records the trap by value
+// in its payload entry: the cause and, for address-related traps,
+// the faulting address. No trap object is allocated on the exception
+// path. The trap object expected by take_trap() is rebuilt on the
+// stack, from this record, only when the trap is actually taken at
+// retirement (see pipeline_t::take_trap_record() in retire.cc).
+/////////////////////////////////////////////////////////////////////
+struct trap_record_t {
+	uint64_t cause;
+	uint64_t badvaddr;
+
+	void post(uint64_t which, uint64_t addr = 0) {
+		cause = which;
+		badvaddr = addr;
+	}
+};
@@ -0,0 +1,239 @@
+#include "value_pred.h"
+
+value_pred::value_pred(uint64_t n_entries, unsigned int threshold, uint64_t n_phys_regs)
+{
+    assert((n_entries > 0) && ((n_entries & (n_entries - 1)) == 0));
+    assert((threshold >= 1) && (threshold <= 15));
+    this->n_entries = n_entries;
+    index_mask = n_entries - 1;
+    this->threshold = threshold;
+    conf_max = 15;
+
+    table = new Entry[n_entries];
+    for (uint64_t i = 0; i < n_entries; i++)
+    {
+        table[i].valid = false;
+        table[i].tag = 0;
+        table[i].last = 0;
+        table[i].last_seq = 0;
+        table[i].dispatched = 0;
+        table[i].stride = 0;
+        table[i].conf = 0;
+    }
+
+    state = NULL;
+    pred_value = NULL;
+    entry = NULL;
+    entry_tag = NULL;
+    seq = NULL;
+    branch_mask = NULL;
+    resize(n_phys_regs);
+
+    stat_eligible = 0;
+    stat_predicted = 0;
+    stat_correct = 0;
+    stat_wrong = 0;
+}
+
+value_pred::~value_pred()
+{
+    delete[] table;
+    delete[] state;
+    delete[] pred_value;
+    delete[] entry;
+    delete[] entry_tag;
+    delete[] seq;
+    delete[] branch_mask;
+}
+
+void value_pred::resize(uint64_t n_phys_regs)
+{
+    delete[] state;
+    delete[] pred_value;
+    delete[] entry;
+    delete[] entry_tag;
+    delete[] seq;
+    delete[] branch_mask;
+    this->n_phys_regs = n_phys_regs;
+    state = new uint8_t[n_phys_regs];
+    pred_value = new uint64_t[n_phys_regs];
+    entry = new uint64_t[n_phys_regs];
+    entry_tag = new uint64_t[n_phys_regs];
+    seq = new uint64_t[n_phys_regs];
+    branch_mask = new uint64_t[n_phys_regs];
+    for (uint64_t p = 0; p < n_phys_regs; p++)
+    {
+        state[p] = VP_NONE;
+        pred_value[p] = 0;
+        entry[p] = n_entries;
+        entry_tag[p] = 0;
+        seq[p] = 0;
+        branch_mask[p] = 0;
+    }
+
+    ////the in-flight instances were dropped: nothing is dispatched after 'last'////
+    for (uint64_t i = 0; i < n_entries; i++)
+    {
+        table[i].dispatched = table[i].last_seq;
+    }
+}
+
+void value_pred::discard(uint64_t phys_reg)
+{
+    if (tracked(phys_reg))
+    {
+        Entry &e = table[entry[phys_reg]];
+
+        ////the squashed instances are the youngest: reuse their sequence numbers////
+        if (e.dispatched >= seq[phys_reg])
+            e.dispatched = seq[phys_reg] - 1;
+
+        ////a squashed instance may already have executed: step 'last' back to a surviving sequence number////
+        if (e.last_seq > e.dispatched)
+        {
+            e.last -= (uint64_t)e.stride * (e.last_seq - e.dispatched);
+            e.last_seq = e.dispatched;
+        }
+    }
+    entry[phys_reg] = n_entries;
+    state[phys_reg] = VP_NONE;
+}
+
+void value_pred::no_predict(uint64_t phys_reg)
+{
+    assert(phys_reg < n_phys_regs);
+    if (state[phys_reg] != VP_NONE)
+        discard(phys_reg);
+}
+
+bool value_pred::predict(uint64_t pc, uint64_t phys_reg, uint64_t mask, uint64_t &value)
+{
+    assert(phys_reg < n_phys_regs);
+    stat_eligible++;
+
+    ////a register is only reallocated after its instance executed or was squashed////
+    if (state[phys_reg] != VP_NONE)
+        discard(phys_reg);
+
+    uint64_t i = get_index(pc);
+    branch_mask[phys_reg] = mask;
+    if (!table[i].valid || (table[i].tag != get_tag(pc)))
+    {
+        state[phys_reg] = VP_TRAIN;
+        return false;
+    }
+
+    ////expected value of this instance: 'last' plus one stride per sequence number in between////
+    table[i].dispatched++;
+    entry[phys_reg] = i;
+    entry_tag[phys_reg] = table[i].tag;
+    seq[phys_reg] = table[i].dispatched;
+    pred_value[phys_reg] = table[i].last + (uint64_t)table[i].stride * (seq[phys_reg] - table[i].last_seq);
+
+    if (table[i].conf < threshold)
+    {
+        state[phys_reg] = VP_TRAIN;
+        return false;
+    }
+
+    value = pred_value[phys_reg];
+    state[phys_reg] = VP_PREDICTED;
+    stat_predicted++;
+    return true;
+}
+
+bool value_pred::verify(uint64_t pc, uint64_t phys_reg, uint64_t actual)
+{
+    assert(phys_reg < n_phys_regs);
+    if (state[phys_reg] == VP_NONE)
+        return false;
+
+    bool predicted = (state[phys_reg] == VP_PREDICTED);
+    bool wrong = (predicted && (pred_value[phys_reg] != actual));
+    bool tracked_inst = tracked(phys_reg);
+    state[phys_reg] = VP_NONE;
+    entry[phys_reg] = n_entries;
+
+    uint64_t i = get_index(pc);
+    if (tracked_inst)
+    {
+        ////train: confidence follows whether the expected value was right////
+        Entry &e = table[i];
+        uint64_t s = seq[phys_reg];
+        if (pred_value[phys_reg] == actual)
+        {
+            if (e.conf < conf_max) e.conf++;
+        }
+        else
+        {
+            e.conf = 0;
+            ////stride between this result and 'last', whichever instance is younger////
+            if (s > e.last_seq)
+                e.stride = (int64_t)(actual - e.last) / (int64_t)(s - e.last_seq);
+            else if (s < e.last_seq)
+                e.stride = (int64_t)(e.last - actual) / (int64_t)(e.last_seq - s);
+        }
+
+        ////instances execute out of order: 'last' is the youngest result////
+        if (s > e.last_seq)
+        {
+            e.last = actual;
+            e.last_seq = s;
+        }
+    }
+    else if (!table[i].valid || (table[i].tag != get_tag(pc)))
+    {
+        table[i].valid = true;
+        table[i].tag = get_tag(pc);
+        table[i].last = actual;
+        table[i].last_seq = 0;
+        table[i].dispatched = 0;
+        table[i].stride = 0;
+        table[i].conf = 0;
+    }
+
+    if (predicted)
+    {
+        if (wrong)
+            stat_wrong++;
+        else
+            stat_correct++;
+    }
+    return wrong;
+}
+
+void value_pred::clear_branch_mask(uint64_t resolved_mask)
+{
+    for (uint64_t p = 0; p < n_phys_regs; p++)
+    {
+        branch_mask[p] &= ~resolved_mask;
+    }
+}
+
+void value_pred::squash(uint64_t branch_ID)
+{
+    for (uint64_t p = 0; p < n_phys_regs; p++)
+    {
+        if ((state[p] != VP_NONE) && (branch_mask[p] & (1ULL << branch_ID)))
+            discard(p);
+    }
+}
+
+void value_pred::flush()
+{
+    for (uint64_t p = 0; p < n_phys_regs; p++)
+    {
+        if (state[p] != VP_NONE)
+            discard(p);
+    }
+}
+
+void value_pred::dump_stats(FILE *fp)
+{
+    fprintf(fp, "VALUE PRED: entries = %" PRIu64 ", confidence threshold = %u\n", n_entries, (unsigned int)threshold);
+    fprintf(fp, "VALUE PRED: eligible = %" PRIu64 "\n", stat_eligible);
+    fprintf(fp, "VALUE PRED: predicted = %" PRIu64 " (coverage %.2f%%)\n", stat_predicted,
+            (stat_eligible ? 100.0*(double)stat_predicted/(double)stat_eligible : 0.0));
+    fprintf(fp, "VALUE PRED: correct = %" PRIu64 ", wrong = %" PRIu64 " (accuracy %.2f%%)\n", stat_correct, stat_wrong,
+            ((stat_correct + stat_wrong) ? 100.0*(double)stat_correct/(double)(stat_correct + stat_wrong) : 0.0));
+}
@@ -0,0 +1,132 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+
+class value_pred {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// Stride value predictor.
+	//
+	// A direct-mapped, tagged table indexed by instruction PC. Each
+	// entry holds the last result of the instruction, the last observed
+	// stride, and a confidence counter. A last-value predictor is the
+	// special case of a stride of 0. The predictor only predicts once
+	// the confidence counter has reached 'threshold'. A correct outcome
+	// increments the counter, a wrong one resets it.
+	//
+	// Several instances of the same instruction (e.g., in a pipelined
+	// loop) are in flight at once, and they execute out of order. So
+	// each instance gets a sequence number at dispatch, and the entry
+	// remembers the sequence number of the instance that produced
+	// 'last'. An instance 'n' sequence numbers after it is predicted as
+	// last + n * stride. Squashed instances are the youngest ones: the
+	// sequence numbers are rolled back past them.
+	/////////////////////////////////////////////////////////////////////
+	struct Entry
+	{
+		bool valid;
+		uint64_t tag;
+		uint64_t last;		// result of the youngest executed instance
+		uint64_t last_seq;	// its sequence number
+		uint64_t dispatched;	// sequence number of the youngest dispatched instance
+		int64_t stride;
+		uint8_t conf;
+	};
+	struct Entry *table;
+	uint64_t n_entries;	// power of two
+	uint64_t index_mask;
+	uint8_t threshold;
+	uint8_t conf_max;
+
+	/////////////////////////////////////////////////////////////////////
+	// In-flight state per physical register (destination of the
+	// instruction that was looked up at dispatch).
+	// An instance has sequence number seq[p] in table[entry[p]] if
+	// entry[p] < n_entries and the entry still has tag entry_tag[p].
+	/////////////////////////////////////////////////////////////////////
+	enum vp_state {
+		VP_NONE = 0,		// not eligible: not trained, not verified
+		VP_TRAIN = 1,		// eligible, no prediction: train only
+		VP_PREDICTED = 2	// predicted: verify and train
+	};
+	uint8_t *state;
+	uint64_t *pred_value;		// expected value, whether or not it was predicted
+	uint64_t *entry;
+	uint64_t *entry_tag;
+	uint64_t *seq;
+	uint64_t *branch_mask;
+	uint64_t n_phys_regs;
+
+	/////////////////////////////////////////////////////////////////////
+	// Statistics.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t stat_eligible;
+	uint64_t stat_predicted;
+	uint64_t stat_correct;
+	uint64_t stat_wrong;
+
+	uint64_t get_index(uint64_t pc) {return((pc >> 2) & index_mask);}
+	uint64_t get_tag(uint64_t pc) {return(pc >> 2);}
+
+	// Is the instance whose destination is 'phys_reg' still tracked by
+	// its entry?
+	bool tracked(uint64_t phys_reg) {
+		return((entry[phys_reg] < n_entries) && (table[entry[phys_reg]].tag == entry_tag[phys_reg]));
+	}
+
+	// Remove the in-flight instance whose destination is 'phys_reg'
+	// without executing it (squash).
+	void discard(uint64_t phys_reg);
+
+public:
+	/////////////////////////////////////////////////////////////////////
+	// Inputs:
+	// 1. n_entries: number of table entries (must be a power of two).
+	// 2. threshold: confidence required to predict (1 to 15).
+	// 3. n_phys_regs: number of physical registers.
+	/////////////////////////////////////////////////////////////////////
+	value_pred(uint64_t n_entries, unsigned int threshold, uint64_t n_phys_regs);
+	~value_pred();
+
+	/////////////////////////////////////////////////////////////////////
+	// Dispatch Stage: look up the instruction at 'pc' with destination
+	// register 'phys_reg' and branch mask 'mask'. Returns 'true' with
+	// the predicted 'value' if the prediction is confident.
+	// no_predict() marks the destination of an instruction that is not
+	// eligible for value prediction.
+	/////////////////////////////////////////////////////////////////////
+	bool predict(uint64_t pc, uint64_t phys_reg, uint64_t mask, uint64_t &value);
+	void no_predict(uint64_t phys_reg);
+
+	/////////////////////////////////////////////////////////////////////
+	// Execute Stage: the instruction at 'pc' produced 'actual' into
+	// 'phys_reg'. Trains the predictor. Returns 'true' if the value was
+	// predicted and the prediction was wrong (value misprediction).
+	/////////////////////////////////////////////////////////////////////
+	bool verify(uint64_t pc, uint64_t phys_reg, uint64_t actual);
+
+	/////////////////////////////////////////////////////////////////////
+	// 'phys_reg' holds a predicted value that is not verified yet.
+	/////////////////////////////////////////////////////////////////////
+	bool predicted(uint64_t phys_reg) {
+		assert(phys_reg < n_phys_regs);
+		return (state[phys_reg] == VP_PREDICTED);
+	}
+
+	/////////////////////////////////////////////////////////////////////
+	// Branch resolution: a correct branch clears its bits in the branch
+	// masks of in-flight instances; a mispredicted branch removes the
+	// in-flight instances that have its bit set. flush() removes all
+	// in-flight instances (complete squash).
+	/////////////////////////////////////////////////////////////////////
+	void clear_branch_mask(uint64_t resolved_mask);
+	void squash(uint64_t branch_ID);
+	void flush();
+
+	/////////////////////////////////////////////////////////////////////
+	// Change the number of physical registers (renamer reconfiguration).
+	/////////////////////////////////////////////////////////////////////
+	void resize(uint64_t n_phys_regs);
+
+	void dump_stats(FILE *fp);
+};
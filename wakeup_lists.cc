@@ -0,0 +1,179 @@
+#include "wakeup_lists.h"
+
+wakeup_lists::wakeup_lists(uint64_t n_phys_regs, unsigned int n_iq_entries)
+{
+    this->n_phys_regs = n_phys_regs;
+    n_nodes = 3 * n_iq_entries;
+    assert(n_nodes > 0);
+
+    head = new int[n_phys_regs];
+    head_epoch = new uint64_t[n_phys_regs];
+    nodes = new Consumer[n_nodes];
+    free_stack = new int[n_nodes];
+    woken_entry = new unsigned int[n_nodes];
+    woken_operand = new unsigned int[n_nodes];
+
+    ////epoch 0 is stale once flush() starts epoch 1////
+    epoch = 0;
+    for (uint64_t p = 0; p < n_phys_regs; p++)
+    {
+        head[p] = -1;
+        head_epoch[p] = 0;
+    }
+    for (unsigned int n = 0; n < n_nodes; n++)
+    {
+        nodes[n].in_use = false;
+    }
+
+    flush();
+}
+
+wakeup_lists::~wakeup_lists()
+{
+    delete[] head;
+    delete[] head_epoch;
+    delete[] nodes;
+    delete[] free_stack;
+    delete[] woken_entry;
+    delete[] woken_operand;
+}
+
+void wakeup_lists::resize(uint64_t n_phys_regs)
+{
+    delete[] head;
+    delete[] head_epoch;
+
+    this->n_phys_regs = n_phys_regs;
+    head = new int[n_phys_regs];
+    head_epoch = new uint64_t[n_phys_regs];
+
+    ////stale in the current epoch, so every list reads as empty////
+    for (uint64_t p = 0; p < n_phys_regs; p++)
+    {
+        head[p] = -1;
+        head_epoch[p] = epoch - 1;
+    }
+
+    flush();
+}
+
+void wakeup_lists::unlink(int n)
+{
+    if (nodes[n].prev >= 0)
+        nodes[nodes[n].prev].next = nodes[n].next;
+    else
+        head[nodes[n].phys_reg] = nodes[n].next;
+
+    if (nodes[n].next >= 0)
+        nodes[nodes[n].next].prev = nodes[n].prev;
+
+    release(n);
+}
+
+void wakeup_lists::release(int n)
+{
+    ////remove from the live list and return to the free stack////
+    if (nodes[n].live_prev >= 0)
+        nodes[nodes[n].live_prev].live_next = nodes[n].live_next;
+    else
+        live_head = nodes[n].live_next;
+
+    if (nodes[n].live_next >= 0)
+        nodes[nodes[n].live_next].live_prev = nodes[n].live_prev;
+
+    nodes[n].in_use = false;
+    free_stack[free_count] = n;
+    free_count++;
+}
+
+void wakeup_lists::add(uint64_t phys_reg, unsigned int entry, unsigned int operand, uint64_t branch_mask)
+{
+    assert(phys_reg < n_phys_regs);
+    int n;
+    if (free_count > 0)
+    {
+        free_count--;
+        n = free_stack[free_count];
+    }
+    else
+    {
+        assert(next_fresh < n_nodes);
+        n = next_fresh;
+        next_fresh++;
+    }
+
+    nodes[n].entry = entry;
+    nodes[n].operand = operand;
+    nodes[n].branch_mask = branch_mask;
+    nodes[n].phys_reg = phys_reg;
+    nodes[n].in_use = true;
+
+    ////push at the head of the list of phys_reg////
+    int first = get_head(phys_reg);
+    nodes[n].prev = -1;
+    nodes[n].next = first;
+    if (first >= 0)
+        nodes[first].prev = n;
+    head[phys_reg] = n;
+    head_epoch[phys_reg] = epoch;
+
+    ////push at the head of the live list////
+    nodes[n].live_prev = -1;
+    nodes[n].live_next = live_head;
+    if (live_head >= 0)
+        nodes[live_head].live_prev = n;
+    live_head = n;
+}
+
+unsigned int wakeup_lists::wakeup(uint64_t phys_reg)
+{
+    unsigned int count = 0;
+    int n = get_head(phys_reg);
+
+    while (n >= 0)
+    {
+        int next = nodes[n].next;
+        woken_entry[count] = nodes[n].entry;
+        woken_operand[count] = nodes[n].operand;
+        count++;
+
+        release(n);
+        n = next;
+    }
+    head[phys_reg] = -1;
+    return count;
+}
+
+void wakeup_lists::clear_branch_bit(uint64_t branch_ID)
+{
+    clear_branch_mask(1ULL << branch_ID);
+}
+
+void wakeup_lists::clear_branch_mask(uint64_t resolved_mask)
+{
+    for (int n = live_head; n >= 0; n = nodes[n].live_next)
+    {
+        nodes[n].branch_mask &= ~resolved_mask;
+    }
+}
+
+void wakeup_lists::squash(uint64_t branch_ID)
+{
+    int n = live_head;
+    while (n >= 0)
+    {
+        int next = nodes[n].live_next;
+        if (nodes[n].branch_mask & (1ULL << branch_ID))
+            unlink(n);
+        n = next;
+    }
+}
+
+void wakeup_lists::flush()
+{
+    ////all heads of the old epoch become stale////
+    epoch++;
+    free_count = 0;
+    next_fresh = 0;
+    live_head = -1;
+}
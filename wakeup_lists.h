@@ -0,0 +1,129 @@
+#include <inttypes.h>
+#include <assert.h>
+
+/////////////////////////////////////////////////////////////////////
+// Source operands of an IQ entry.
+/////////////////////////////////////////////////////////////////////
+enum wakeup_operand {
+	OPERAND_A = 0,
+	OPERAND_B = 1,
+	OPERAND_D = 2
+};
+
+class wakeup_lists {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// Indexed wakeup engine.
+	//
+	// Instead of broadcasting a destination tag to every IQ entry, each
+	// physical register keeps a list of the IQ entries (and which of
+	// their source operands) that are waiting on it. Wakeup of a tag
+	// touches only the consumers on that tag's list.
+	//
+	// Each consumer is a node taken from a fixed pool, so registering
+	// and waking up consumers never allocates memory. A node also holds
+	// the branch mask of its IQ entry, so that lists can be pruned when
+	// branches resolve or squash. All nodes in use are also linked on a
+	// live list, so branch resolution and squash visit only the current
+	// consumers, not the whole pool.
+	/////////////////////////////////////////////////////////////////////
+	struct Consumer
+	{
+		unsigned int entry;	// IQ entry of the consumer
+		unsigned int operand;	// which source operand (A, B, or D) is waiting
+		uint64_t branch_mask;
+		uint64_t phys_reg;	// list this node is on
+		int next, prev;		// doubly-linked list of consumers of phys_reg
+		int live_next, live_prev;	// doubly-linked list of all nodes in use
+		bool in_use;
+	};
+
+	uint64_t n_phys_regs;
+	unsigned int n_nodes;
+
+	/////////////////////////////////////////////////////////////////////
+	// Flush epoch.
+	// flush() does not visit the lists or the pool: it increments the
+	// epoch. A list head from an older epoch reads as empty; the pool and
+	// the live list are simply reset.
+	/////////////////////////////////////////////////////////////////////
+	uint64_t epoch;
+
+	/////////////////////////////////////////////////////////////////////
+	// head[p]: first consumer of physical register p, or -1 if none.
+	// head[p] is only meaningful if head_epoch[p] is the current epoch.
+	/////////////////////////////////////////////////////////////////////
+	int *head;
+	uint64_t *head_epoch;
+
+	/////////////////////////////////////////////////////////////////////
+	// Node pool and its free stack.
+	// Nodes [next_fresh, n_nodes) have not been allocated since the last
+	// flush() and are free without being on the free stack.
+	/////////////////////////////////////////////////////////////////////
+	struct Consumer *nodes;
+	int *free_stack;
+	unsigned int free_count;
+	unsigned int next_fresh;
+
+	/////////////////////////////////////////////////////////////////////
+	// live_head: first node in use, or -1 if none.
+	/////////////////////////////////////////////////////////////////////
+	int live_head;
+
+	/////////////////////////////////////////////////////////////////////
+	// Consumers removed by the most recent wakeup().
+	/////////////////////////////////////////////////////////////////////
+	unsigned int *woken_entry;
+	unsigned int *woken_operand;
+
+	void unlink(int n);
+	void release(int n);
+	int get_head(uint64_t phys_reg) {return ((head_epoch[phys_reg] == epoch) ? head[phys_reg] : -1);}
+
+public:
+	/////////////////////////////////////////////////////////////////////
+	// The constructor is given the number of physical registers and the
+	// number of IQ entries. Every IQ entry has at most three sources,
+	// which sizes the node pool.
+	/////////////////////////////////////////////////////////////////////
+	wakeup_lists(uint64_t n_phys_regs, unsigned int n_iq_entries);
+	~wakeup_lists();
+
+	/////////////////////////////////////////////////////////////////////
+	// Change the number of physical registers (renamer reconfiguration).
+	// All consumers are removed.
+	/////////////////////////////////////////////////////////////////////
+	void resize(uint64_t n_phys_regs);
+
+	/////////////////////////////////////////////////////////////////////
+	// Register a not-ready source operand of an IQ entry on the list of
+	// the physical register it is waiting for (Dispatch Stage).
+	/////////////////////////////////////////////////////////////////////
+	void add(uint64_t phys_reg, unsigned int entry, unsigned int operand, uint64_t branch_mask);
+
+	/////////////////////////////////////////////////////////////////////
+	// Remove all consumers of the indicated physical register.
+	// Returns the number of consumers; consumer 'i' (0 <= i < count) is
+	// then available through get_entry(i) and get_operand(i) until the
+	// next call to wakeup().
+	/////////////////////////////////////////////////////////////////////
+	unsigned int wakeup(uint64_t phys_reg);
+	unsigned int get_entry(unsigned int i) {return woken_entry[i];}
+	unsigned int get_operand(unsigned int i) {return woken_operand[i];}
+
+	/////////////////////////////////////////////////////////////////////
+	// Branch resolution: a correct branch clears its bit in the branch
+	// masks of all consumers (clear_branch_mask() clears several at once);
+	// a mispredicted branch prunes all consumers that have its bit set.
+	// Both take time proportional to the number of consumers.
+	/////////////////////////////////////////////////////////////////////
+	void clear_branch_bit(uint64_t branch_ID);
+	void clear_branch_mask(uint64_t resolved_mask);
+	void squash(uint64_t branch_ID);
+
+	/////////////////////////////////////////////////////////////////////
+	// Remove all consumers (complete squash). This takes constant time.
+	/////////////////////////////////////////////////////////////////////
+	void flush();
+};
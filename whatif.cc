@@ -0,0 +1,133 @@
+#include "whatif.h"
+#include <unistd.h>
+#include <errno.h>
+#include <sys/wait.h>
+
+whatif::whatif(unsigned int n_variants)
+{
+    assert(n_variants > 0);
+    this->n_variants = n_variants;
+    pids = new pid_t[n_variants];
+    fds = new int[n_variants];
+    results = new whatif_result_t[n_variants];
+    for (unsigned int v = 0; v < n_variants; v++)
+    {
+        pids[v] = -1;
+        fds[v] = -1;
+        results[v].variant = v;
+        results[v].ok = 0;
+        results[v].cycles = 0;
+        results[v].instructions = 0;
+    }
+}
+
+whatif::~whatif()
+{
+    delete[] pids;
+    delete[] fds;
+    delete[] results;
+}
+
+bool whatif::read_result(int fd, whatif_result_t &result)
+{
+    char *p = (char *)&result;
+    size_t left = sizeof(result);
+    while (left > 0)
+    {
+        ssize_t n = read(fd, p, left);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        left -= n;
+    }
+    return true;
+}
+
+bool whatif::run(whatif_fn_t fn, void *context)
+{
+    bool ok = true;
+
+    ////don't duplicate buffered output into the children////
+    fflush(NULL);
+
+    for (unsigned int v = 0; v < n_variants; v++)
+    {
+        int fd[2];
+        if (pipe(fd) != 0)
+        {
+            ok = false;
+            break;
+        }
+
+        pids[v] = fork();
+        if (pids[v] < 0)
+        {
+            close(fd[0]);
+            close(fd[1]);
+            ok = false;
+            break;
+        }
+
+        if (pids[v] == 0)
+        {
+            ////child: run the variant, send the result, and exit without running destructors////
+            close(fd[0]);
+            whatif_result_t r;
+            r.variant = v;
+            r.ok = 0;
+            r.cycles = 0;
+            r.instructions = 0;
+            fn(v, context, r);
+            r.variant = v;
+            r.ok = 1;
+            ssize_t n = write(fd[1], &r, sizeof(r));
+            fflush(NULL);
+            _exit((n == (ssize_t)sizeof(r)) ? 0 : 1);
+        }
+
+        close(fd[1]);
+        fds[v] = fd[0];
+    }
+
+    ////parent: collect the results////
+    for (unsigned int v = 0; v < n_variants; v++)
+    {
+        if (fds[v] >= 0)
+        {
+            if (!read_result(fds[v], results[v]))
+            {
+                results[v].variant = v;
+                results[v].ok = 0;
+            }
+            close(fds[v]);
+            fds[v] = -1;
+        }
+        if (pids[v] > 0)
+        {
+            int status;
+            while ((waitpid(pids[v], &status, 0) < 0) && (errno == EINTR))
+                ;
+            pids[v] = -1;
+        }
+        if (!results[v].ok)
+            ok = false;
+    }
+    return ok;
+}
+
+void whatif::report(FILE *fp)
+{
+    for (unsigned int v = 0; v < n_variants; v++)
+    {
+        if (!results[v].ok)
+        {
+            fprintf(fp, "WHATIF: variant %u: FAILED\n", v);
+            continue;
+        }
+        fprintf(fp, "WHATIF: variant %u: cycles = %" PRIu64 ", instructions = %" PRIu64 ", IPC = %.4f\n",
+                v, results[v].cycles, results[v].instructions,
+                (results[v].cycles ? (double)results[v].instructions/(double)results[v].cycles : 0.0));
+    }
+}
@@ -0,0 +1,68 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <assert.h>
+#include <sys/types.h>
+
+/////////////////////////////////////////////////////////////////////
+// Parameters that can be changed in a warmed pipeline.
+// A field left at its "unchanged" value keeps the parent's setting.
+/////////////////////////////////////////////////////////////////////
+struct reconfig_t {
+	uint64_t n_phys_regs;	// 0: unchanged
+	uint64_t n_branches;	// 0: unchanged
+	int mem_dep_pred;	// -1: unchanged, else MEM_DEP_PRED
+	int spec_disambig;	// -1: unchanged, else SPEC_DISAMBIG
+	int steer_policy;	// -1: unchanged, else a steer_policy (see lane_steer.h)
+
+	reconfig_t() : n_phys_regs(0), n_branches(0), mem_dep_pred(-1), spec_disambig(-1), steer_policy(-1) {}
+};
+
+/////////////////////////////////////////////////////////////////////
+// Result of one what-if child, sent to the parent over a pipe.
+/////////////////////////////////////////////////////////////////////
+struct whatif_result_t {
+	uint32_t variant;
+	uint32_t ok;		// the child ran to completion
+	uint64_t cycles;
+	uint64_t instructions;
+};
+
+/////////////////////////////////////////////////////////////////////
+// Runs variant 'variant' in a child process and fills in 'result'.
+/////////////////////////////////////////////////////////////////////
+typedef void (*whatif_fn_t)(unsigned int variant, void *context, whatif_result_t &result);
+
+class whatif {
+private:
+	/////////////////////////////////////////////////////////////////////
+	// fork()-based what-if exploration.
+	//
+	// The parent warms the pipeline once and then forks one child per
+	// variant. The children share all unmodified memory with the parent
+	// copy-on-write (the memory image of the simulated program is never
+	// rebuilt), change one parameter of their own copy of the pipeline,
+	// and simulate the next window in parallel. Each child writes one
+	// fixed-size result record into its pipe and exits.
+	/////////////////////////////////////////////////////////////////////
+	unsigned int n_variants;
+	pid_t *pids;
+	int *fds;			// read end of each child's pipe
+	struct whatif_result_t *results;
+
+	static bool read_result(int fd, whatif_result_t &result);
+
+public:
+	whatif(unsigned int n_variants);
+	~whatif();
+
+	/////////////////////////////////////////////////////////////////////
+	// Fork the children, run fn(v, context, result) in child 'v', and
+	// wait for all of them. Returns 'false' if any child failed.
+	// Output buffered in stdio is flushed before forking.
+	/////////////////////////////////////////////////////////////////////
+	bool run(whatif_fn_t fn, void *context);
+
+	whatif_result_t &result(unsigned int variant) {assert(variant < n_variants); return results[variant];}
+
+	void report(FILE *fp);
+};
@@ -1,16 +1,19 @@
 #include "pipeline.h"
+#include "timeline.h"
+#include "squash_epoch.h"
 
 
 void pipeline_t::writeback(unsigned int lane_number) {
    unsigned int index;
 
    // Check if there is an instruction in the Writeback Stage of the specified Execution Lane.
-   if (Execution_Lanes[lane_number].wb.valid) {
+   if (REG_VALID(Execution_Lanes[lane_number].wb)) {
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
       // Get the instruction's index into PAY.
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
       index = Execution_Lanes[lane_number].wb.index;
+      TIMELINE.stamp(index, TL_WRITEBACK, cycle);
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
       // FIX_ME #15
@@ -33,7 +36,7 @@ void pipeline_t::writeback(unsigned int lane_number) {
       //   logically after the branch.
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-      if (PAY.buf[index].checkpoint) {
+      if (PAY.hot(index).checkpoint) {
 
          if (PERFECT_BRANCH_PRED) {
             // TODO: This assert fails due to asynchrony caused by HTIF ticks.
@@ -45,8 +48,8 @@ void pipeline_t::writeback(unsigned int lane_number) {
             // retired in micro_sim. The CSR read instruction will force a recovery and
             // the next time this branch is executed, it will calculate the right value.
 
-            //assert(PAY.buf[index].next_pc == PAY.buf[index].c_next_pc);
-            assert((PAY.buf[index].next_pc == PAY.buf[index].c_next_pc) || !PAY.buf[index].good_instruction || SPEC_DISAMBIG);
+            //assert(PAY.cold(index).next_pc == PAY.cold(index).c_next_pc);
+            assert((PAY.cold(index).next_pc == PAY.cold(index).c_next_pc) || !PAY.cold(index).good_instruction || SPEC_DISAMBIG);
 
             // FIX_ME #15a
             // The simulator is running in perfect branch prediction mode, therefore, all branches are correctly predicted.
@@ -54,7 +57,7 @@ void pipeline_t::writeback(unsigned int lane_number) {
             // matches the outcome (c_next_pc is the calculated target).
             //
             // Tips:
-            // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+            // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
             // 2. Call the resolve() function of the renamer module so that it frees the branch's checkpoint.
             //    Recall that the arguments to resolve() are:
             //    * Active List index
@@ -63,11 +66,11 @@ void pipeline_t::writeback(unsigned int lane_number) {
             // 3. Do NOT worry about clearing the branch's bit in the branch masks of instructions in the pipeline.
             //    This is unnecessary since instructions don't need accurate branch masks in perfect branch prediction
             //    mode... since they are never squashed anyway.
-            REN->resolve(PAY.buf[index].AL_index, PAY.buf[index].branch_ID, true);
+            REN->resolve(PAY.hot(index).AL_index, PAY.hot(index).branch_ID, true);
 
 
          }
-         else if (PAY.buf[index].next_pc == PAY.buf[index].c_next_pc) {
+         else if (PAY.cold(index).next_pc == PAY.cold(index).c_next_pc) {
             // Branch was predicted correctly.
 
             // FIX_ME #15b
@@ -84,17 +87,24 @@ void pipeline_t::writeback(unsigned int lane_number) {
             //    * resolve() takes two arguments. The first argument is the branch's ID. The second argument is a flag that
             //      indicates whether or not the branch was predicted correctly: in this case it is correct.
             //    * See pipeline.h for details about the two arguments of resolve().
-            REN->resolve(PAY.buf[index].AL_index, PAY.buf[index].branch_ID, true);
-            resolve(PAY.buf[index].branch_ID, true);
+            //
+            // Several branches may resolve in the same cycle across lanes. Rather than sweeping the renamer
+            // and all branch masks once per branch, collect the branch in this cycle's resolved mask;
+            // resolve_batch() applies the whole mask at once.
+            resolved_mask |= (1ULL << PAY.hot(index).branch_ID);
 
 
          }
          else {
             // Branch was mispredicted.
 
+            // Apply correct resolutions collected earlier this cycle before recovering, so that the
+            // checkpointed GBM restored below no longer carries their bits.
+            resolve_batch();
+
             // Roll-back the fetch unit: PC and branch predictor.
-            pc = PAY.buf[index].c_next_pc;					// PC gets the correct target of the resolved branch.
-            BP.fix_pred(PAY.buf[index].pred_tag, PAY.buf[index].c_next_pc);	// Roll-back the branch predictor to the point of the resolved branch.
+            pc = PAY.cold(index).c_next_pc;					// PC gets the correct target of the resolved branch.
+            BP.fix_pred(PAY.cold(index).pred_tag, PAY.cold(index).c_next_pc);	// Roll-back the branch predictor to the point of the resolved branch.
  
             // Clear the fetch unit's exception, amo, and csr flags.  The fetch unit stalls on these conditions.
             // Therefore, we can infer that the mispredicted branch is logically before any offending instruction,
@@ -118,24 +128,25 @@ void pipeline_t::writeback(unsigned int lane_number) {
             // 1. See #15a, item 1.
             // 2. See #15a, item 2 -- EXCEPT in this case the branch was mispredicted, so specify not-correct instead of correct.
             //    This will restore the RMT, FL, and AL, and also free this and future checkpoints... etc.
-            REN->resolve(PAY.buf[index].AL_index, PAY.buf[index].branch_ID, false);
+            REN->resolve(PAY.hot(index).AL_index, PAY.hot(index).branch_ID, false);
 
 
             // Restore the LQ/SQ.
-            LSU.restore(PAY.buf[index].LQ_index, PAY.buf[index].LQ_phase, PAY.buf[index].SQ_index, PAY.buf[index].SQ_phase);
+            LSU.restore(PAY.hot(index).LQ_index, PAY.hot(index).LQ_phase, PAY.hot(index).SQ_index, PAY.hot(index).SQ_phase);
 
             // FIX_ME #15d
             // Squash instructions after the branch in program order, in all pipeline registers and the IQ.
             //
             // Tips:
-            // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+            // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
             // 2. Squash instructions after the branch in program order.
             //    To do this, call the resolve() function with the appropriate arguments. This function does the work for you.
             //    * resolve() is a private function of the pipeline_t class, therefore, just call it literally as 'resolve'.
             //    * resolve() takes two arguments. The first argument is the branch's ID. The second argument is a flag that
             //      indicates whether or not the branch was predicted correctly: in this case it is not-correct.
             //    * See pipeline.h for details about the two arguments of resolve().
-            resolve(PAY.buf[index].branch_ID, false);
+            resolve(PAY.hot(index).branch_ID, false);
+            TIMELINE.squash_after(PAY.cold(index).sequence, cycle);
 
 
             // Rollback PAY to the point of the branch.
@@ -148,10 +159,10 @@ void pipeline_t::writeback(unsigned int lane_number) {
       // Set completed bit in Active List.
       //
       // Tips:
-      // 1. At this point of the code, 'index' is the instruction's index into PAY.buf[] (payload).
+      // 1. At this point of the code, 'index' is the instruction's index into the payload (PAY).
       // 2. Set the completed bit for this instruction in the Active List.
       //////////////////////////////////////////////////////////////////////////////////////////////////////////
-      REN->set_complete(PAY.buf[index].AL_index);
+      REN->set_complete(PAY.hot(index).AL_index);
 
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////